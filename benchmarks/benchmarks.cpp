@@ -0,0 +1,448 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+//
+// Benchmark suite for the wssr kernels and the solvers.
+//
+// Every benchmark runs for all combinations of data set size (10^2 to 10^7 points), input dimensions
+// (1, 2 and 4) and parameter counts (4 and 16). For each run the suite reports the time per data point,
+// the number of function evaluations and the number of heap allocations per call. The results are
+// written as JSON to stdout or to the file given with --output, a short table is printed to stderr.
+// The solvers run with the default options and with the strong Wolfe line search, the entries of the solver
+// benchmarks record the line search.
+//
+// Usage: minimize-benchmarks [--max-size N] [--output FILE]
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "minimize/minimize.hpp"
+
+namespace {
+
+std::atomic<std::size_t> allocation_count{0};
+
+// All replaceable allocation functions are replaced, so every new and delete pair goes through the same
+// counted malloc and free and none of them reaches the default allocator.
+void* counted_allocate(std::size_t size) noexcept {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* counted_allocate_or_throw(std::size_t size) {
+    if (void* p = counted_allocate(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void counted_free(void* p) noexcept { std::free(p); }
+
+}  // namespace
+
+void* operator new(std::size_t size) { return counted_allocate_or_throw(size); }
+void* operator new[](std::size_t size) { return counted_allocate_or_throw(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size); }
+
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+
+#if defined(__cpp_aligned_new)
+namespace {
+
+// The aligned forms store the pointer returned by malloc in front of the aligned block.
+void* counted_allocate_aligned(std::size_t size, std::align_val_t alignment) noexcept {
+    const auto align = static_cast<std::size_t>(alignment);
+    void* raw = counted_allocate(size + align + sizeof(void*));
+    if (raw == nullptr) {
+        return nullptr;
+    }
+    const auto first = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+    void* aligned = reinterpret_cast<void*>((first + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1));
+    static_cast<void**>(aligned)[-1] = raw;
+    return aligned;
+}
+
+void* counted_allocate_aligned_or_throw(std::size_t size, std::align_val_t alignment) {
+    if (void* p = counted_allocate_aligned(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void counted_free_aligned(void* p) noexcept {
+    if (p != nullptr) {
+        counted_free(static_cast<void**>(p)[-1]);
+    }
+}
+
+}  // namespace
+
+void* operator new(std::size_t size, std::align_val_t a) { return counted_allocate_aligned_or_throw(size, a); }
+void* operator new[](std::size_t size, std::align_val_t a) { return counted_allocate_aligned_or_throw(size, a); }
+void* operator new(std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return counted_allocate_aligned(size, a);
+}
+void* operator new[](std::size_t size, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return counted_allocate_aligned(size, a);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { counted_free_aligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free_aligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free_aligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free_aligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counted_free_aligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_free_aligned(p); }
+#endif
+
+namespace {
+
+/** Largest data set used for the bootstrap, every worker of the thread pool holds a copy of the data. */
+constexpr std::size_t max_bootstrap_size = 1000000;
+
+/** Iteration limit of the fits. */
+constexpr std::size_t fit_iterations = 10;
+
+/** Number of resamples of the bootstrap benchmark. */
+constexpr std::size_t bootstrap_resamples = 4;
+
+inline minimize::floating_t component(minimize::floating_t x, std::size_t) { return x; }
+
+template <std::size_t N>
+minimize::floating_t component(const std::array<minimize::floating_t, N>& x, std::size_t d) {
+    return x[d];
+}
+
+inline void set_component(minimize::floating_t& x, std::size_t, minimize::floating_t v) { x = v; }
+
+template <std::size_t N>
+void set_component(std::array<minimize::floating_t, N>& x, std::size_t d, minimize::floating_t v) {
+    x[d] = v;
+}
+
+/**
+ * Polynomial surface p0 + sum_k p_k * x_(k mod In)^(1 + k / In) with an exact gradient.
+ * The model is linear in its parameters, so the wssr is a quadratic form and the work done by the fits
+ * does not depend on the noise of the data.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+class BenchmarkModel : public minimize::StaticFunction<BenchmarkModel<InputDimensions, NumberOfParameters>,
+                                                       InputDimensions, NumberOfParameters> {
+public:
+    using base_t = minimize::StaticFunction<BenchmarkModel<InputDimensions, NumberOfParameters>, InputDimensions,
+                                            NumberOfParameters>;
+    using input_t = typename base_t::input_t;
+    using output_t = typename base_t::output_t;
+    using parameter_t = typename base_t::parameter_t;
+
+    BenchmarkModel() {
+        parameter_t p;
+        for (std::size_t k = 0; k < NumberOfParameters; ++k) {
+            p[k] = 1.0 / static_cast<minimize::floating_t>(k + 1);
+        }
+        this->set_parameters(p);
+    }
+
+    output_t model(const input_t& x, const parameter_t& parameters) const {
+        return model_with_gradient(x, parameters).value;
+    }
+
+    minimize::ValueAndGradient<NumberOfParameters> model_with_gradient(const input_t& x,
+                                                                       const parameter_t& parameters) const {
+        minimize::ValueAndGradient<NumberOfParameters> rv;
+        std::array<minimize::floating_t, InputDimensions> powers;
+        for (std::size_t d = 0; d < InputDimensions; ++d) {
+            powers[d] = 1.0;
+        }
+        rv.gradient[0] = 1.0;
+        rv.value = parameters[0];
+        for (std::size_t k = 1; k < NumberOfParameters; ++k) {
+            const std::size_t d = (k - 1) % InputDimensions;
+            powers[d] *= component(x, d);
+            rv.gradient[k] = powers[d];
+            rv.value += parameters[k] * powers[d];
+        }
+        return rv;
+    }
+};
+
+/** Forwards all calls to a model and counts the evaluated points. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+class CountingFunction : public minimize::Function<InputDimensions, NumberOfParameters> {
+public:
+    using base_t = minimize::Function<InputDimensions, NumberOfParameters>;
+    using input_t = typename base_t::input_t;
+    using output_t = typename base_t::output_t;
+    using parameter_t = typename base_t::parameter_t;
+
+    CountingFunction(const base_t& model, std::atomic<std::size_t>& counter)
+        : base_t(model.parameters()), model_(model), counter_(counter) {}
+
+    output_t evaluate(const input_t& x, const parameter_t& parameters) const override {
+        counter_.fetch_add(1, std::memory_order_relaxed);
+        return model_.evaluate(x, parameters);
+    }
+    using base_t::evaluate;
+
+    minimize::ValueAndGradient<NumberOfParameters> evaluate_with_gradient(
+        const input_t& x, const parameter_t& parameters) const override {
+        counter_.fetch_add(1, std::memory_order_relaxed);
+        return model_.evaluate_with_gradient(x, parameters);
+    }
+    using base_t::evaluate_with_gradient;
+
+    void evaluate_batch(const input_t* x, std::size_t count, const parameter_t& parameters,
+                        output_t* out) const override {
+        counter_.fetch_add(count, std::memory_order_relaxed);
+        model_.evaluate_batch(x, count, parameters, out);
+    }
+
+    void evaluate_with_gradient_batch(const input_t* x, std::size_t count, const parameter_t& parameters,
+                                      output_t* values, parameter_t* gradients) const override {
+        counter_.fetch_add(count, std::memory_order_relaxed);
+        model_.evaluate_with_gradient_batch(x, count, parameters, values, gradients);
+    }
+
+private:
+    const base_t& model_;
+    std::atomic<std::size_t>& counter_;
+};
+
+/** Result of one benchmark run. */
+struct Result {
+    std::string name;
+    /** Line search of the solver benchmarks, empty for the other benchmarks. */
+    std::string line_search;
+    std::size_t size;
+    std::size_t input_dimensions;
+    std::size_t parameters;
+    std::size_t repetitions;
+    double seconds;
+    double evaluations;
+    double allocations;
+};
+
+/** Noisy measurements of the benchmark model with uniformly distributed positions in [-1, 1]. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+minimize::MeasurementVector<InputDimensions> create_data(std::size_t size) {
+    const BenchmarkModel<InputDimensions, NumberOfParameters> model{};
+    std::mt19937 gen{42};
+    std::uniform_real_distribution<minimize::floating_t> position(-1.0, 1.0);
+    std::normal_distribution<minimize::floating_t> noise(0.0, 0.01);
+    minimize::MeasurementVector<InputDimensions> rv;
+    rv.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        minimize::Measurement<InputDimensions> m;
+        for (std::size_t d = 0; d < InputDimensions; ++d) {
+            set_component(m.in, d, position(gen));
+        }
+        m.out = model.evaluate(m.in) + noise(gen);
+        rv.push_back(m);
+    }
+    return rv;
+}
+
+/** Repeats the callable until about target_points data points were processed and measures the time,
+ * the evaluations and the allocations per call. The callable receives the index of the repetition.
+ */
+template <typename Callable>
+Result measure(const std::string& name, std::size_t size, std::size_t input_dimensions, std::size_t parameters,
+               std::size_t target_points, std::atomic<std::size_t>& counter, const Callable& fun) {
+    Result rv;
+    rv.name = name;
+    rv.size = size;
+    rv.input_dimensions = input_dimensions;
+    rv.parameters = parameters;
+    rv.repetitions = target_points > size ? target_points / size : 1;
+    counter.store(0);
+    const std::size_t allocations_before = allocation_count.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rv.repetitions; ++i) {
+        fun(i);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const auto repetitions = static_cast<double>(rv.repetitions);
+    rv.seconds = std::chrono::duration<double>(end - start).count() / repetitions;
+    rv.evaluations = static_cast<double>(counter.load()) / repetitions;
+    rv.allocations = static_cast<double>(allocation_count.load() - allocations_before) / repetitions;
+    return rv;
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+void run_configuration(std::size_t max_size, std::vector<Result>& results) {
+    using parameter_t = minimize::parameter_t<NumberOfParameters>;
+    const BenchmarkModel<InputDimensions, NumberOfParameters> model{};
+    parameter_t start = model.parameters();
+    for (auto& p : start) {
+        p *= 0.9;
+    }
+    std::atomic<std::size_t> counter{0};
+    CountingFunction<InputDimensions, NumberOfParameters> function{model, counter};
+    function.set_parameters(start);
+
+    minimize::SolverOptions options;
+    options.max_iterations = fit_iterations;
+    options.tolerance = 1e-12;
+    options.bootstrap.resamples = 0;
+    // the default options and the strong Wolfe search are tracked separately
+    minimize::SolverOptions wolfe_options = options;
+    wolfe_options.line_search = minimize::LineSearch::strong_wolfe;
+
+    for (std::size_t size = 100; size <= max_size; size *= 10) {
+        const auto data = create_data<InputDimensions, NumberOfParameters>(size);
+        volatile minimize::floating_t sink = 0.0;
+        const auto gradient = minimize::compute_wssr_gradient(function, data, start);
+        auto add_with_line_search = [&](const std::string& name, const std::string& line_search,
+                                        std::size_t target_points, const std::function<void()>& fun) {
+            results.push_back(measure(name, size, InputDimensions, NumberOfParameters, target_points, counter,
+                                      [&](std::size_t) {
+                                          function.set_parameters(start);
+                                          fun();
+                                      }));
+            results.back().line_search = line_search;
+            const auto& r = results.back();
+            std::cerr << std::left << std::setw(28) << r.name << std::setw(14) << r.line_search << std::right
+                      << std::setw(10) << r.size
+                      << std::setw(4) << r.input_dimensions << std::setw(4) << r.parameters << std::fixed
+                      << std::setprecision(2) << std::setw(12) << 1e9 * r.seconds / static_cast<double>(r.size)
+                      << std::setprecision(1) << std::setw(12) << r.evaluations / static_cast<double>(r.size)
+                      << std::setw(10) << r.allocations << "\n";
+        };
+        auto add = [&](const std::string& name, std::size_t target_points, const std::function<void()>& fun) {
+            add_with_line_search(name, "", target_points, fun);
+        };
+
+        add("compute_wssr", 10000000, [&]() { sink = sink + minimize::compute_wssr(function, data, start); });
+        std::vector<parameter_t> candidates(4, start);
+        for (std::size_t k = 0; k < candidates.size(); ++k) {
+            candidates[k][0] *= 1.0 + 0.01 * static_cast<minimize::floating_t>(k);
+        }
+        std::vector<minimize::floating_t> candidate_wssr(candidates.size());
+        add("compute_wssr_multi_4", 10000000, [&]() {
+            minimize::compute_wssr_multi(function, data, candidates.data(), candidates.size(), candidate_wssr.data());
+            sink = sink + candidate_wssr[0];
+        });
+        // rejects the candidate once half of its wssr is summed
+        const auto reject_threshold = 0.5 * minimize::compute_wssr(function, data, candidates[3]);
+        add("compute_wssr_bounded_reject", 10000000, [&]() {
+            const auto wssr = minimize::compute_wssr_bounded(function, data, candidates[3], reject_threshold);
+            sink = sink + (std::isinf(wssr) ? 1.0 : wssr);
+        });
+        add("compute_wssr_gradient", 10000000,
+            [&]() { sink = sink + minimize::compute_wssr_gradient(function, data, start)[0]; });
+        const auto start_wssr = minimize::compute_wssr(function, data, start);
+        add("find_minimum_on_line", 1000000, [&]() {
+            sink = sink + minimize::find_minimum_on_line(function, start, start_wssr, data, gradient, 128).wssr;
+        });
+        for (const auto* fit_options : {&options, &wolfe_options}) {
+            const std::string line_search = fit_options == &options ? "automatic" : "strong_wolfe";
+            add_with_line_search("steepest_descent", line_search, 100000, [&]() {
+                sink = sink +
+                       minimize::steepest_descent(function, data, *fit_options).weighted_sum_of_squared_residuals();
+            });
+            add_with_line_search("conjugate_gradient_descent", line_search, 100000, [&]() {
+                const auto fit = minimize::conjugate_gradient_descent(function, data, *fit_options);
+                sink = sink + fit.weighted_sum_of_squared_residuals();
+            });
+        }
+        if (size <= max_bootstrap_size) {
+            minimize::BootstrapOptions bootstrap;
+            bootstrap.resamples = bootstrap_resamples;
+            add_with_line_search("bootstrap_errors", "automatic", 10000, [&]() {
+                const auto fit = minimize::bootstrap_errors<InputDimensions, NumberOfParameters,
+                                                            minimize::MeasurementVector<InputDimensions>>(
+                    function, data,
+                    [&options](const minimize::Function<InputDimensions, NumberOfParameters>& f,
+                               const minimize::MeasurementVector<InputDimensions>& d, minimize::floating_t,
+                               std::size_t) {
+                        return minimize::detail::conjugate_gradient_descent_impl(f, d, options);
+                    },
+                    bootstrap, options.tolerance, options.max_iterations);
+                sink = sink + fit.optimized_value_errors()[0];
+            });
+        }
+    }
+}
+
+void write_json(std::ostream& out, const std::vector<Result>& results) {
+    out << "{\n";
+    out << "  \"threads\": " << minimize::thread_count() << ",\n";
+    out << "  \"fit_iterations\": " << fit_iterations << ",\n";
+    out << "  \"bootstrap_resamples\": " << bootstrap_resamples << ",\n";
+    out << "  \"benchmarks\": [\n";
+    out << std::setprecision(6);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", ";
+        if (!r.line_search.empty()) {
+            out << "\"line_search\": \"" << r.line_search << "\", ";
+        }
+        out << "\"size\": " << r.size
+            << ", \"input_dimensions\": " << r.input_dimensions << ", \"parameters\": " << r.parameters
+            << ", \"repetitions\": " << r.repetitions << ", \"seconds\": " << r.seconds
+            << ", \"ns_per_point\": " << 1e9 * r.seconds / static_cast<double>(r.size)
+            << ", \"evaluations\": " << r.evaluations << ", \"allocations\": " << r.allocations << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t max_size = 10000000;
+    std::string output;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--max-size" && i + 1 < argc) {
+            max_size = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--max-size N] [--output FILE]\n";
+            return 1;
+        }
+    }
+
+    std::cerr << std::left << std::setw(28) << "# benchmark" << std::setw(14) << "line search" << std::right
+              << std::setw(10) << "size"
+              << std::setw(4) << "in" << std::setw(4) << "p" << std::setw(12) << "ns/point" << std::setw(12)
+              << "passes" << std::setw(10) << "allocs" << "\n";
+    std::vector<Result> results;
+    run_configuration<1, 4>(max_size, results);
+    run_configuration<1, 16>(max_size, results);
+    run_configuration<2, 4>(max_size, results);
+    run_configuration<2, 16>(max_size, results);
+    run_configuration<4, 4>(max_size, results);
+    run_configuration<4, 16>(max_size, results);
+
+    if (output.empty()) {
+        write_json(std::cout, results);
+    } else {
+        std::ofstream file(output);
+        write_json(file, results);
+        if (!file) {
+            std::cerr << "Could not write '" << output << "'\n";
+            return 1;
+        }
+    }
+    return 0;
+}
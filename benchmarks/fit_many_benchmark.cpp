@@ -0,0 +1,48 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+//
+// Measures the throughput of minimize::fit_many for a growing number of threads.
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "minimize/minimize.hpp"
+
+int main() {
+    constexpr std::size_t datasets_count = 4000;
+    std::vector<minimize::MeasurementVector<1>> datasets(datasets_count);
+    for (std::size_t k = 0; k < datasets_count; ++k) {
+        for (std::size_t i = 0; i < 50; ++i) {
+            const double x = 0.1 * i;
+            const double y = 0.5 + 0.001 * k - 0.3 * x + 0.02 * x * x + 0.01 * std::sin(17.0 * x + k);
+            datasets[k].emplace_back(minimize::Measurement<1>{x, y});
+        }
+    }
+    minimize::Polynomial<2> prototype{};
+    minimize::SolverOptions options;
+    options.bootstrap.resamples = 16;
+
+    const std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "# fit_many: " << datasets_count << " data sets, Levenberg-Marquardt with 16 bootstrap resamples\n";
+    std::cout << "# threads      fits/s   speedup\n";
+    double single = 0.0;
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        minimize::set_thread_count(threads);
+        const auto start = std::chrono::steady_clock::now();
+        const auto results = minimize::fit_many(prototype, datasets, minimize::Solver::levenberg_marquardt, options);
+        const auto end = std::chrono::steady_clock::now();
+        const double rate = results.size() / std::chrono::duration<double>(end - start).count();
+        if (threads == 1) {
+            single = rate;
+        }
+        std::cout << std::setw(9) << threads << std::fixed << std::setprecision(1) << std::setw(12) << rate
+                  << std::setprecision(2) << std::setw(10) << rate / single << "\n";
+    }
+    minimize::set_thread_count(1);
+    return 0;
+}
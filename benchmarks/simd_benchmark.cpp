@@ -0,0 +1,91 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+//
+// Compares the simd levels of the wssr reduction kernels on 10^6 data points: the kernels alone on
+// precomputed function values, and compute_wssr / compute_wssr_gradient of a cheap polynomial model.
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "minimize/minimize.hpp"
+
+namespace {
+
+constexpr std::size_t points = 1000000;
+constexpr std::size_t repetitions = 20;
+
+template <typename Callable>
+double measure_ns_per_point(const Callable& fun) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < repetitions; ++i) {
+        fun();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return 1e9 * std::chrono::duration<double>(end - start).count() / static_cast<double>(points * repetitions);
+}
+
+const char* level_name(minimize::SimdLevel level) {
+    switch (level) {
+        case minimize::SimdLevel::avx512:
+            return "avx512";
+        case minimize::SimdLevel::avx2:
+            return "avx2";
+        case minimize::SimdLevel::sse2:
+            return "sse2";
+        case minimize::SimdLevel::scalar:
+            break;
+    }
+    return "scalar";
+}
+
+}  // namespace
+
+int main() {
+    minimize::StaticPolynomial<3> polynomial{{1.0, -2.0, 0.5, 0.1}};
+    minimize::MeasurementVector<1> vec{};
+    minimize::MeasurementColumns<1> columns{};
+    columns.reserve(points);
+    std::vector<minimize::floating_t> values(points);
+    for (std::size_t i = 0; i < points; ++i) {
+        const double x = 1e-6 * static_cast<double>(i);
+        const double y = polynomial.evaluate(x) + 0.01 * std::sin(37.0 * x);
+        vec.emplace_back(minimize::Measurement<1>{x, y});
+        columns.push_back(x, y, 1.0 + 0.5 * std::cos(x));
+        values[i] = polynomial.evaluate(x);
+    }
+    const auto parameters = polynomial.parameters();
+
+    std::cout << "# wssr reduction kernels, " << points << " points, ns per point\n";
+    std::cout << std::left << std::setw(10) << "# level" << std::right << std::setw(12) << "kernel" << std::setw(12)
+              << "wssr vec" << std::setw(12) << "wssr col" << std::setw(14) << "gradient col" << std::setw(24)
+              << "wssr" << "\n";
+    const auto supported = minimize::set_simd_level(minimize::SimdLevel::avx512);
+    for (const auto level : {minimize::SimdLevel::scalar, minimize::SimdLevel::sse2, minimize::SimdLevel::avx2,
+                             minimize::SimdLevel::avx512}) {
+        if (static_cast<int>(level) > static_cast<int>(supported)) {
+            break;
+        }
+        minimize::set_simd_level(level);
+        const auto& kernels = minimize::detail::simd_kernels();
+        volatile double sink = 0.0;
+        const double kernel = measure_ns_per_point([&]() {
+            sink = sink + kernels.sum_weighted_squared_differences(values.data(), columns.outputs(),
+                                                                   columns.weights(), points);
+        });
+        const double wssr_vec = measure_ns_per_point([&]() { sink = sink + compute_wssr(polynomial, vec); });
+        const double wssr_col = measure_ns_per_point([&]() { sink = sink + compute_wssr(polynomial, columns); });
+        const double gradient_col =
+            measure_ns_per_point([&]() { sink = sink + compute_wssr_gradient(polynomial, columns)[0]; });
+        std::cout << std::left << std::setw(10) << level_name(level) << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(12) << kernel << std::setw(12) << wssr_vec << std::setw(12)
+                  << wssr_col << std::setw(14) << gradient_col << std::setprecision(17) << std::setw(24)
+                  << compute_wssr(polynomial, columns, parameters) << "\n";
+    }
+    minimize::set_simd_level(supported);
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+//
+// Compares the run time of models derived from minimize::Function (virtual call per data point)
+// with the same models derived from minimize::StaticFunction (model inlined into the batch loop).
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "minimize/minimize.hpp"
+
+namespace {
+
+constexpr double sqrt_2pi = 2.50662827463100050241576528481104525300698674060993831662992357;
+
+/** Polynomial of degree 3 with a virtual call per point, like the polynomials before StaticFunction. */
+class VirtualPolynomial : public minimize::Function<1, 4> {
+public:
+    VirtualPolynomial() : minimize::Function<1, 4>({1.0, -2.0, 0.5, 0.1}) {}
+
+    output_t evaluate(const input_t& x, const parameter_t& parameters) const override {
+        minimize::floating_t t = 1.0;
+        minimize::floating_t rv = parameters[0];
+        for (size_t i = 1; i <= 3; ++i) {
+            t *= x;
+            rv += t * parameters[i];
+        }
+        return rv;
+    }
+    using minimize::Function<1, 4>::evaluate;
+};
+
+inline minimize::floating_t gaussian_2d(const std::array<minimize::floating_t, 2>& x,
+                                        const minimize::parameter_t<6>& p) {
+    const auto ax = (x[0] - p[0]) / p[1];
+    const auto ay = (x[1] - p[2]) / p[3];
+    return p[4] * std::exp(-0.5 * (ax * ax + ay * ay)) / (p[1] * p[3] * sqrt_2pi * sqrt_2pi) + p[5];
+}
+
+/** The 2-d gaussian of examples/gaussian_fit.cpp. */
+class VirtualGaussian : public minimize::Function<2, 6> {
+public:
+    VirtualGaussian() : minimize::Function<2, 6>({-3.0, 4.0, 1.3, 2.1, 160.2, 3.0}) {}
+
+    output_t evaluate(const input_t& x, const parameter_t& parameters) const override {
+        return gaussian_2d(x, parameters);
+    }
+    using minimize::Function<2, 6>::evaluate;
+};
+
+class StaticGaussian : public minimize::StaticFunction<StaticGaussian, 2, 6> {
+public:
+    StaticGaussian() : minimize::StaticFunction<StaticGaussian, 2, 6>({-3.0, 4.0, 1.3, 2.1, 160.2, 3.0}) {}
+
+    output_t model(const input_t& x, const parameter_t& parameters) const { return gaussian_2d(x, parameters); }
+};
+
+template <typename Callable>
+double measure_seconds(const Callable& fun) {
+    const auto start = std::chrono::steady_clock::now();
+    fun();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/** Measures the time per point of compute_wssr and compute_wssr_gradient and the time of 20 iterations of a fit. */
+template <typename Model, typename DataVector>
+void run(const std::string& name, Model& model, const DataVector& data, std::size_t repetitions) {
+    const auto start_parameters = model.parameters();
+    volatile double sink = 0.0;
+    const double wssr_seconds = measure_seconds([&]() {
+        for (std::size_t i = 0; i < repetitions; ++i) {
+            sink = sink + minimize::compute_wssr(model, data);
+        }
+    });
+    const double gradient_seconds = measure_seconds([&]() {
+        for (std::size_t i = 0; i < repetitions; ++i) {
+            sink = sink + minimize::compute_wssr_gradient(model, data)[0];
+        }
+    });
+    auto start = start_parameters;
+    for (auto& p : start) {
+        p *= 0.9;
+    }
+    model.set_parameters(start);
+    const double fit_seconds = measure_seconds([&]() {
+        const auto results = minimize::detail::conjugate_gradient_descent_impl(model, data, 1e-10, 20);
+        sink = sink + results.weighted_sum_of_squared_residuals();
+    });
+    model.set_parameters(start_parameters);
+
+    const double points = static_cast<double>(data.size() * repetitions);
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << 1e9 * wssr_seconds / points << std::setw(16) << 1e9 * gradient_seconds / points
+              << std::setw(12) << 1e3 * fit_seconds << "\n";
+}
+
+}  // namespace
+
+int main() {
+    constexpr std::size_t repetitions = 20;
+    std::cout << "# Virtual Function vs. StaticFunction\n";
+    std::cout << std::left << std::setw(24) << "# model" << std::right << std::setw(12) << "wssr ns/pt" << std::setw(16)
+              << "gradient ns/pt" << std::setw(12) << "20 it. ms" << "\n";
+
+    minimize::MeasurementVector<1> line{};
+    VirtualPolynomial reference_polynomial{};
+    for (std::size_t i = 0; i < 100000; ++i) {
+        const double x = 1e-4 * static_cast<double>(i);
+        line.emplace_back(minimize::Measurement<1>{x, reference_polynomial.evaluate(x) + 0.01 * std::sin(37.0 * x)});
+    }
+    VirtualPolynomial virtual_polynomial{};
+    minimize::StaticPolynomial<3> static_polynomial{reference_polynomial.parameters()};
+    run("Function Polynomial<3>", virtual_polynomial, line, repetitions);
+    run("StaticFunction Poly<3>", static_polynomial, line, repetitions);
+
+    minimize::MeasurementVector<2> grid{};
+    VirtualGaussian reference_gaussian{};
+    for (int i = 0; i < 200; ++i) {
+        for (int k = 0; k < 200; ++k) {
+            const std::array<double, 2> x{{0.1 * (i - 100), 0.1 * (k - 100)}};
+            grid.emplace_back(minimize::Measurement<2>{x, reference_gaussian.evaluate(x) + 0.01 * std::sin(x[0] * x[1])});
+        }
+    }
+    VirtualGaussian virtual_gaussian{};
+    StaticGaussian static_gaussian{};
+    run("Function Gaussian 2d", virtual_gaussian, grid, repetitions);
+    run("StaticFunction Gaussian", static_gaussian, grid, repetitions);
+    return 0;
+}
@@ -39,6 +39,29 @@ public:
     }
     using minimize::Function<2, 6>::evaluate;
 
+    /** Value and gradient in one call - optional.
+     * Without this override, the gradient is computed numerically with 4 extra
+     * evaluations per parameter. The analytic version reuses the two exponentials.
+     */
+    minimize::ValueAndGradient<6> evaluate_with_gradient(const input_t& x,
+                                                         const parameter_t& parameters) const override {
+        const auto gx = gaussian1d(x[0], parameters[0], parameters[1]);
+        const auto gy = gaussian1d(x[1], parameters[2], parameters[3]);
+        const auto dx = x[0] - parameters[0];
+        const auto dy = x[1] - parameters[2];
+        const auto scaled = gx * gy * parameters[4];
+        minimize::ValueAndGradient<6> rv;
+        rv.value = scaled + parameters[5];
+        rv.gradient[0] = scaled * dx / (parameters[1] * parameters[1]);
+        rv.gradient[1] = scaled * (dx * dx / (parameters[1] * parameters[1] * parameters[1]) - 1.0 / parameters[1]);
+        rv.gradient[2] = scaled * dy / (parameters[3] * parameters[3]);
+        rv.gradient[3] = scaled * (dy * dy / (parameters[3] * parameters[3] * parameters[3]) - 1.0 / parameters[3]);
+        rv.gradient[4] = gx * gy;
+        rv.gradient[5] = 1.0;
+        return rv;
+    }
+    using minimize::Function<2, 6>::evaluate_with_gradient;
+
     minimize::floating_t gaussian1d(minimize::floating_t x, minimize::floating_t mean,
                                     minimize::floating_t stddev) const {
         const auto arg = (x - mean) / stddev;
@@ -46,6 +69,12 @@ public:
                std::exp(-0.5 * arg * arg);
     }
 
+    /** Declares the parameters that enter the function linearly - optional.
+     * amplitude and offset are linear, so variable_projection() can eliminate them
+     * and only iterate the means and standard deviations.
+     */
+    bool is_linear_parameter(size_t i) const override { return i >= 4; }
+
     /** custom parameter names in the report - optional. */
     std::string parameter_name(size_t i) const override {
         switch (i) {
@@ -107,7 +136,7 @@ int main(int argc, char**) {
     gauss.set_parameter(4, 1.0);
     gauss.set_parameter(5, 0.0);
     // fit
-    const auto results = minimize::conjugate_gradient_descent(gauss, data);
+    const auto results = minimize::variable_projection(gauss, data);
 
     // print results
 
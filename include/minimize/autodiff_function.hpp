@@ -0,0 +1,49 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_AUTODIFF_FUNCTION_INCLUDED_HPP
+#define MINIMIZE_AUTODIFF_FUNCTION_INCLUDED_HPP
+
+#include <array>
+#include <cstddef>
+
+#include "minimize/dual.hpp"
+#include "minimize/function.hpp"
+
+namespace minimize {
+
+/**
+ * @brief Base class for functions with a gradient computed by forward mode automatic differentiation.
+ *
+ * Derive as `class MyModel : public AutoDiffFunction<MyModel, In, P>` and write the model once as template:
+ * `template <typename T> T model(const input_t& x, const std::array<T, P>& parameters) const`.
+ * The function is evaluated with T = floating_t for plain values. The gradient is computed in a single
+ * evaluation with T = Dual<P>, so it is exact and does not depend on the numerical differentiation epsilon.
+ * Call math functions unqualified after e.g. `using std::exp;`, so that the overloads for Dual are found.
+ */
+template <typename Derived, std::size_t InputDimensions, std::size_t NumberOfParameters>
+class AutoDiffFunction : public StaticFunction<Derived, InputDimensions, NumberOfParameters> {
+public:
+    using base_t = StaticFunction<Derived, InputDimensions, NumberOfParameters>;
+    using output_t = typename base_t::output_t;
+    using input_t = typename base_t::input_t;
+    using parameter_t = typename base_t::parameter_t;
+    using dual_t = Dual<NumberOfParameters>;
+    using base_t::base_t;
+
+    ValueAndGradient<NumberOfParameters> model_with_gradient(const input_t& x, const parameter_t& parameters) const {
+        std::array<dual_t, NumberOfParameters> variables;
+        for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+            variables[i] = dual_t::variable(parameters[i], i);
+        }
+        const dual_t result = static_cast<const Derived&>(*this).model(x, variables);
+        ValueAndGradient<NumberOfParameters> rv;
+        rv.value = result.value;
+        rv.gradient = result.derivatives;
+        return rv;
+    }
+};
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_AUTODIFF_FUNCTION_INCLUDED_HPP */
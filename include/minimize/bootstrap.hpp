@@ -4,13 +4,23 @@
 #ifndef MINIMIZE_BOOTSTRAP_INCLUDED_HPP
 #define MINIMIZE_BOOTSTRAP_INCLUDED_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <functional>
+#include <mutex>
 #include <random>
+#include <utility>
+#include <vector>
 
 #include "minimize/detail/bootstrap.hpp"
 #include "minimize/detail/vector_math.hpp"
 #include "minimize/fit_results.hpp"
+#include "minimize/instrumentation.hpp"
 #include "minimize/measurement.hpp"
+#include "minimize/observer.hpp"
+#include "minimize/thread_pool.hpp"
 
 namespace minimize {
 
@@ -19,35 +29,222 @@ template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename
 using minimize_function_t = std::function<minimize::FitResults<NumberOfParameters>(
     const Function<InputDimensions, NumberOfParameters>&, const DataVector&, minimize::floating_t, std::size_t)>;
 
+/** Method used to estimate the errors of the optimized parameters. */
+enum class ErrorEstimation {
+    /** bootstrap for measurements in memory, covariance for data that is too large for the memory, like a
+     * MappedMeasurementFile. The bootstrap holds N residuals and copies of the measured values in memory.
+     */
+    automatic,
+    /** Fits resamples of the data generated from the residuals. Costs one fit per resample. */
+    bootstrap,
+    /** Inverts J^T W J at the optimum, scaled by WSSR/NDF. Costs a single pass over the data, but assumes
+     * that the function is approximately linear in its parameters close to the optimum.
+     */
+    covariance
+};
+
+/** Settings for the error estimation.
+ *
+ * The template argument selects the random number engine used to draw the residuals.
+ */
+template <typename RandomEngine = std::mt19937>
+struct BasicBootstrapOptions {
+    using random_engine_t = RandomEngine;
+
+    /** Method of the error estimation. With ErrorEstimation::covariance, all other settings are ignored. */
+    ErrorEstimation errors{ErrorEstimation::automatic};
+
+    /** Maximum number of resampled fits. 0 disables the error estimation. */
+    std::size_t resamples{16};
+
+    /** Seed for the random number generators. Resample i draws from a generator seeded with (seed, i),
+     * so the results for a given seed are reproducible and do not depend on the number of threads.
+     */
+    std::uint64_t seed{5489u};
+
+    /** Stop early once the relative change of every error between two checks is below this value.
+     * 0 disables the early stop.
+     */
+    minimize::floating_t stop_tolerance{0.0};
+
+    /** Minimum number of resamples between two checks for the early stop. The checks are done after blocks of
+     * at least one resample per thread, so that all threads are busy.
+     */
+    std::size_t check_interval{8};
+
+    /** Called after every finished resample with its parameters and wssr. Calls are serialized, but may come
+     * from any thread of the pool. Returning ObserverAction::stop skips the remaining resamples, the errors are
+     * computed from the finished ones.
+     */
+    FitObserver observer{};
+};
+
+using BootstrapOptions = BasicBootstrapOptions<>;
+
+namespace detail {
+
+/** Returns true if the relative change of all values is below the tolerance. */
+template <std::size_t NumberOfParameters>
+bool errors_are_stable(const minimize::parameter_t<NumberOfParameters>& previous,
+                       const minimize::parameter_t<NumberOfParameters>& current, minimize::floating_t tolerance) {
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        const auto change = std::abs(current[i] - previous[i]);
+        if (change > tolerance * std::abs(current[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace detail
+
 /** Bootstrap the error estimation by generating new measurements from the residuals.
  * Each of the new distributions is used to fit the function, then the standard
  * deviation for every parameter is used to estimate its error.
  *
  * The method to minimize the parameters can be given as callbacks.
+ * The resampled fits are independent and run on the library thread pool (see set_thread_count()).
+ * Every worker owns one random number generator and one sample buffer that is overwritten in place
+ * for each resample. The results are merged in the order of the resamples.
+ *
+ * The covariance of the resampled parameters is stored in the results. If the options select
+ * ErrorEstimation::covariance, no resamples are fitted and the errors are computed from J^T W J instead.
+ * ErrorEstimation::automatic does the same for data that is not held in memory, like a MappedMeasurementFile.
+ *
+ * The fit is cancelled if the minimizer returns cancelled results or the observer in the options returns
+ * ObserverAction::stop. If the main fit is cancelled, no resamples are fitted.
+ * The iteration observers of the solvers only watch the main fit, not the resamples.
  */
-template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector, typename RandomEngine>
 minimize::FitResults<NumberOfParameters> bootstrap_errors(
     Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
     minimize_function_t<InputDimensions, NumberOfParameters, DataVector> minimizer,
-    minimize::floating_t tolerance = 1e-15, std::size_t max_iterations = 16535) {
+    const BasicBootstrapOptions<RandomEngine>& options, minimize::floating_t tolerance = 1e-15,
+    std::size_t max_iterations = 16535) {
     auto results = minimizer(function, measurements, tolerance, max_iterations);
     function.set_parameters(results.optimized_values());
+    if (results.cancelled()) {
+        return results;
+    }
+    const bool covariance = options.errors == ErrorEstimation::covariance ||
+                            (options.errors == ErrorEstimation::automatic && detail::is_out_of_core<DataVector>::value);
+    if (covariance) {
+        minimize::detail::estimate_covariance_errors(function, measurements, results);
+        return results;
+    }
+    if (options.resamples == 0 || measurements.size() == 0) {
+        return results;
+    }
 
-    std::vector<minimize::parameter_t<NumberOfParameters>> bootstrap_results;
-    constexpr size_t num_steps = 16;
-    bootstrap_results.reserve(num_steps);
+    const auto model_values = minimize::detail::compute_model_values(function, measurements);
+    std::vector<minimize::floating_t> residuals;
+    residuals.reserve(model_values.size());
+    std::size_t index = 0;
+    for (const auto& x : measurements) {
+        residuals.push_back(x.out - model_values[index]);
+        ++index;
+    }
+
+    auto& pool = minimize::detail::global_thread_pool();
+    // nested in a pool task, e.g. in fit_many(), the resamples run serially and need a single sample buffer
+    const std::size_t workers = pool.concurrency(options.resamples);
+    std::vector<RandomEngine> generators(workers);
+    std::vector<DataVector> samples(workers, measurements);
+    std::vector<minimize::parameter_t<NumberOfParameters>> bootstrap_results(options.resamples);
+    std::vector<char> finished_resamples(options.resamples, 0);
+    std::atomic<bool> cancelled{false};
+    std::mutex observer_mutex;
+    std::size_t observed = 0;
+    std::vector<double> resample_seconds(instrumentation_enabled ? options.resamples : 0);
 
-    const auto residuals = minimize::detail::compute_residuals(function, measurements);
-    for (size_t i = 0; i < num_steps; ++i) {
-        const auto sample = minimize::detail::create_sample_data(function, measurements, residuals);
-        const auto step_results = minimizer(function, sample, tolerance, max_iterations);
-        bootstrap_results.push_back(step_results.optimized_values());
+    const bool early_stop = options.stop_tolerance > 0.0 && options.check_interval > 0;
+    // the stop criterion is checked between blocks, a block keeps all workers busy
+    const std::size_t block_size = early_stop ? std::max(options.check_interval, workers) : options.resamples;
+    std::size_t finished = 0;
+    minimize::parameter_t<NumberOfParameters> errors{};
+    while (finished < options.resamples) {
+        const std::size_t count = std::min(block_size, options.resamples - finished);
+        pool.parallel_for(count, [&](std::size_t i, std::size_t worker) {
+            if (cancelled.load()) {
+                return;
+            }
+            auto& gen = generators[worker];
+            auto& sample = samples[worker];
+            minimize::detail::seed_resample_generator(gen, options.seed, finished + i);
+            minimize::detail::resample_into(model_values, residuals, gen, sample);
+            const minimize::detail::ResampleFitScope scope;
+            const auto step_results = minimizer(function, sample, tolerance, max_iterations);
+            if (step_results.cancelled()) {
+                cancelled.store(true);
+                return;
+            }
+            bootstrap_results[finished + i] = step_results.optimized_values();
+            finished_resamples[finished + i] = 1;
+            if (instrumentation_enabled) {
+                resample_seconds[finished + i] = step_results.statistics().fit_seconds();
+            }
+            if (options.observer) {
+                std::lock_guard<std::mutex> lock(observer_mutex);
+                FitProgress progress;
+                progress.iteration = ++observed;
+                progress.parameters = step_results.optimized_values().data();
+                progress.number_of_parameters = NumberOfParameters;
+                progress.wssr = step_results.weighted_sum_of_squared_residuals();
+                if (options.observer(progress) == ObserverAction::stop) {
+                    cancelled.store(true);
+                }
+            }
+        });
+        const bool first_block = finished == 0;
+        finished += count;
+        if (!early_stop || finished == options.resamples || cancelled.load()) {
+            break;
+        }
+        const std::vector<minimize::parameter_t<NumberOfParameters>> current(bootstrap_results.begin(),
+                                                                              bootstrap_results.begin() + finished);
+        const auto next_errors = minimize::detail::compute_stddev(current);
+        const bool stable =
+            !first_block && minimize::detail::errors_are_stable(errors, next_errors, options.stop_tolerance);
+        errors = next_errors;
+        if (stable) {
+            break;
+        }
+    }
+    bootstrap_results.resize(finished);
+    if (cancelled.load()) {
+        // keep only the resamples that were fitted before the cancellation
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < finished; ++i) {
+            if (finished_resamples[i] != 0) {
+                bootstrap_results[kept++] = bootstrap_results[i];
+            }
+        }
+        bootstrap_results.resize(kept);
+        results.set_cancelled(true);
+    }
+    if (!bootstrap_results.empty()) {
+        results.set_optimized_value_errors(minimize::detail::compute_stddev(bootstrap_results));
+        results.set_covariance(minimize::detail::compute_covariance(bootstrap_results));
+    }
+    if (instrumentation_enabled) {
+        resample_seconds.resize(finished);
+        auto statistics = results.statistics();
+        statistics.set_resample_seconds(std::move(resample_seconds));
+        results.set_statistics(statistics);
     }
-    results.set_optimized_value_errors(minimize::detail::compute_stddev(bootstrap_results));
 
     return results;
 }
 
+/** Bootstrap the error estimation with the default options. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> bootstrap_errors(
+    Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
+    minimize_function_t<InputDimensions, NumberOfParameters, DataVector> minimizer,
+    minimize::floating_t tolerance = 1e-15, std::size_t max_iterations = 16535) {
+    return bootstrap_errors(function, measurements, minimizer, BootstrapOptions{}, tolerance, max_iterations);
+}
+
 } /* namespace minimize */
 
 #endif /* MINIMIZE_BOOTSTRAP_INCLUDED_HPP */
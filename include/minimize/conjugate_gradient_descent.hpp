@@ -5,10 +5,12 @@
 #define MINIMIZE_CONJUGATE_GRADIENT_DESCENT_INCLUDED_HPP
 
 #include "minimize/bootstrap.hpp"
-#include "minimize/find_minimum_on_line.hpp"
 #include "minimize/fit_results.hpp"
 #include "minimize/function.hpp"
+#include "minimize/line_search.hpp"
 #include "minimize/measurement.hpp"
+#include "minimize/observer.hpp"
+#include "minimize/solver_options.hpp"
 #include "minimize/wssr.hpp"
 
 namespace minimize {
@@ -27,67 +29,110 @@ minimize::floating_t compute_gamma(const minimize::parameter_t<NumberOfParameter
     return num / denom;
 }
 
+/** Runs NumberOfParameters line searches along conjugate directions. current holds the wssr and gradient at minimum,
+ * both are updated with the accepted points. */
 template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
 minimize::floating_t conjugate_gradient_descent_step(const Function<InputDimensions, NumberOfParameters>& function,
                                                      minimize::parameter_t<NumberOfParameters>& minimum,
-                                                     const DataVector& measurements) {
-    auto wssr = compute_wssr(function, measurements, minimum);
-    auto gi = compute_wssr_gradient(function, measurements, minimum);
+                                                     WssrAndGradient<NumberOfParameters>& current,
+                                                     const DataVector& measurements, LineSearch method,
+                                                     LineSearchState& state) {
+    auto gi = current.gradient;
     auto conjugate_gradient = gi;
     for (size_t i = 0; i < NumberOfParameters; ++i) {
-        const auto next_parameters = find_minimum_on_line(function, minimum, measurements, conjugate_gradient, 128);
-        const auto next_wssr = compute_wssr(function, measurements, next_parameters);
-        if (next_wssr >= wssr) {
+        const auto next = line_search(function, measurements, minimum, current, conjugate_gradient, method, state);
+        if (next.value.wssr >= current.wssr) {
             break;
         }
-        wssr = next_wssr;
-        minimum = next_parameters;
-        const auto gi_plus1 = compute_wssr_gradient(function, measurements, minimum);
+        minimum = next.parameters;
+        current = next.value;
+        const auto& gi_plus1 = current.gradient;
         const auto gamma = compute_gamma(gi, gi_plus1);
         gi = gi_plus1;
         conjugate_gradient = detail::axpy(gamma, conjugate_gradient, gi_plus1);
+        if (detail::dot(conjugate_gradient, gi) <= 0.0) {
+            // not a descent direction, restart with the gradient
+            conjugate_gradient = gi;
+        }
     }
 
-    return wssr;
+    return current.wssr;
 }
 
 template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
 minimize::FitResults<NumberOfParameters> conjugate_gradient_descent_impl(
     const Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
-    minimize::floating_t tolerance = 1e-15, std::size_t max_iterations = 16535) {
+    const SolverOptions& options) {
+    FitRecorder recorder;
     std::size_t iterations = 0;
 
-    auto wssr = compute_wssr(function, measurements);
+    auto minimum = function.parameters();
+    auto current = compute_wssr_and_gradient(function, measurements, minimum);
+    auto wssr = current.wssr;
     minimize::FitResults<NumberOfParameters> results(wssr, measurements.size());
     results.initialize_before_fit(function);
-    auto minimum = function.parameters();
+    record_wssr(wssr);
+    LineSearchState state;
     minimize::floating_t rel_change;
+    bool cancelled = false;
     do {
-        const auto next_wssr = detail::conjugate_gradient_descent_step(function, minimum, measurements);
+        const auto next_wssr =
+            detail::conjugate_gradient_descent_step(function, minimum, current, measurements, options.line_search,
+                                                    state);
         if (next_wssr >= wssr || wssr == 0.0) {
             break;
         }
         rel_change = 1.0 - next_wssr / wssr;
         wssr = next_wssr;
+        record_wssr(wssr);
         ++iterations;
-    } while (iterations < max_iterations && tolerance < rel_change);
-    results.set_converged(iterations < max_iterations);
+        if (observer_stops_fit(options.observer, iterations, minimum, wssr, rel_change)) {
+            cancelled = true;
+            break;
+        }
+    } while (iterations < options.max_iterations && options.tolerance < rel_change);
+    results.set_converged(iterations < options.max_iterations && !cancelled);
+    results.set_cancelled(cancelled);
     results.set_iterations(iterations);
     results.set_weighted_sum_of_squared_residuals(wssr);
     results.set_optimized_values(minimum);
+    recorder.finish(results);
     return results;
 }
 
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> conjugate_gradient_descent_impl(
+    const Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
+    minimize::floating_t tolerance = 1e-15, std::size_t max_iterations = 16535) {
+    SolverOptions options;
+    options.tolerance = tolerance;
+    options.max_iterations = max_iterations;
+    return conjugate_gradient_descent_impl(function, measurements, options);
+}
+
 }  // namespace detail
 
+/** Fits the function parameters by conjugate gradient descent with the given options. */
 template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
 minimize::FitResults<NumberOfParameters> conjugate_gradient_descent(
     Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
-    minimize::floating_t tolerance = 1e-15, std::size_t max_iterations = 16535) {
+    const SolverOptions& options) {
     return minimize::bootstrap_errors<InputDimensions, NumberOfParameters, DataVector>(
         function, measurements,
-        minimize::detail::conjugate_gradient_descent_impl<InputDimensions, NumberOfParameters, DataVector>, tolerance,
-        max_iterations);
+        [&options](const Function<InputDimensions, NumberOfParameters>& f, const DataVector& data,
+                   minimize::floating_t,
+                   std::size_t) { return detail::conjugate_gradient_descent_impl(f, data, options); },
+        options.bootstrap, options.tolerance, options.max_iterations);
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> conjugate_gradient_descent(
+    Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
+    minimize::floating_t tolerance = 1e-15, std::size_t max_iterations = 16535) {
+    SolverOptions options;
+    options.tolerance = tolerance;
+    options.max_iterations = max_iterations;
+    return conjugate_gradient_descent(function, measurements, options);
 }
 
 }  // namespace minimize
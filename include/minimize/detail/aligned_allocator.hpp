@@ -0,0 +1,77 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_DETAIL_ALIGNED_ALLOCATOR_INCLUDED_HPP
+#define MINIMIZE_DETAIL_ALIGNED_ALLOCATOR_INCLUDED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+namespace minimize {
+
+namespace detail {
+
+/** Size of a cache line. Used to align arrays and to pad data written by different threads. */
+constexpr std::size_t cache_line_size = 64;
+
+/**
+ * @brief Allocator returning memory aligned to the given boundary.
+ *
+ * Used for the columns of the measured data, so that vector loads never cross a cache line.
+ */
+template <typename T, std::size_t Alignment = cache_line_size>
+class AlignedAllocator {
+public:
+    static_assert(Alignment >= alignof(void*) && (Alignment & (Alignment - 1)) == 0,
+                  "The alignment must be a power of two!");
+    using value_type = T;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n > (std::numeric_limits<std::size_t>::max() - Alignment - sizeof(void*)) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        // the address of the raw allocation is stored directly in front of the aligned block
+        void* raw = ::operator new(n * sizeof(T) + Alignment + sizeof(void*));
+        const auto start = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+        const auto aligned = (start + Alignment - 1) & ~static_cast<std::uintptr_t>(Alignment - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<T*>(aligned);
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        if (p != nullptr) {
+            ::operator delete(reinterpret_cast<void**>(p)[-1]);
+        }
+    }
+};
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) noexcept {
+    return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) noexcept {
+    return false;
+}
+
+}  // namespace detail
+}  // namespace minimize
+
+#endif /* MINIMIZE_DETAIL_ALIGNED_ALLOCATOR_INCLUDED_HPP */
@@ -4,25 +4,51 @@
 #ifndef MINIMIZE_DETAIL_BOOTSTRAP_INCLUDED_HPP
 #define MINIMIZE_DETAIL_BOOTSTRAP_INCLUDED_HPP
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <random>
+#include <vector>
 
+#include "minimize/detail/linear_algebra.hpp"
+#include "minimize/detail/normal_equations.hpp"
 #include "minimize/detail/vector_math.hpp"
 #include "minimize/fit_results.hpp"
+#include "minimize/mapped_measurement_file.hpp"
 #include "minimize/measurement.hpp"
+#include "minimize/measurement_columns.hpp"
+#include "minimize/wssr.hpp"
 
 namespace minimize {
 
 namespace detail {
 
+/** Computes the values of the function at the positions of the measured data.
+ * The function is evaluated in batches.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+std::vector<floating_t> compute_model_values(const Function<InputDimensions, NumberOfParameters>& fun,
+                                             const DataVector& vec) {
+    using input_t = typename Function<InputDimensions, NumberOfParameters>::input_t;
+    std::array<input_t, batch_size> inputs;
+    std::vector<floating_t> rv(vec.size());
+    for (std::size_t first = 0; first < vec.size(); first += batch_size) {
+        const std::size_t count = std::min(batch_size, vec.size() - first);
+        fun.evaluate_batch(gather_inputs(vec, first, count, inputs.data()), count, fun.parameters(), &rv[first]);
+    }
+    return rv;
+}
+
 /** Computes residuals between the function and the measured data. */
 template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
 std::vector<floating_t> compute_residuals(Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec) {
-    std::vector<floating_t> rv;
-    rv.reserve(vec.size());
+    std::vector<floating_t> rv = compute_model_values(fun, vec);
+    std::size_t i = 0;
     for (const auto& x : vec) {
-        const auto diff = (fun.evaluate(x.in) - x.out);
-        rv.push_back(diff);
+        rv[i] -= x.out;
+        ++i;
     }
     return rv;
 }
@@ -32,12 +58,11 @@ std::vector<floating_t> compute_residuals(Function<InputDimensions, NumberOfPara
  * Using the assumption that the residuals are all independent and sampled from the same distribution, creating data
  * this way gives an approximation of another measurement with the same random noise.
  */
-template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector, typename RandomEngine>
 minimize::MeasurementVector<InputDimensions> create_sample_data(Function<InputDimensions, NumberOfParameters>& fun,
                                                                 const DataVector& vec,
-                                                                const std::vector<floating_t>& residuals) {
-    std::random_device rd{};
-    std::mt19937 gen{rd()};
+                                                                const std::vector<floating_t>& residuals,
+                                                                RandomEngine& gen) {
     std::uniform_int_distribution<std::size_t> dist(0, vec.size() - 1);
     minimize::MeasurementVector<InputDimensions> rv;
     rv.reserve(vec.size());
@@ -48,6 +73,64 @@ minimize::MeasurementVector<InputDimensions> create_sample_data(Function<InputDi
     return rv;
 }
 
+/** @brief Creates fake measurements with a newly seeded random number generator. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::MeasurementVector<InputDimensions> create_sample_data(Function<InputDimensions, NumberOfParameters>& fun,
+                                                                const DataVector& vec,
+                                                                const std::vector<floating_t>& residuals) {
+    std::random_device rd{};
+    std::mt19937 gen{rd()};
+    return create_sample_data(fun, vec, residuals, gen);
+}
+
+/** Seeds the generator for the resample with the given index.
+ * Every resample gets its own random stream, independent of the thread that executes it.
+ */
+template <typename RandomEngine>
+void seed_resample_generator(RandomEngine& gen, std::uint64_t seed, std::uint64_t index) {
+    std::seed_seq sequence{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+                           static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32)};
+    gen.seed(sequence);
+}
+
+/** @brief Overwrites the measured values in sample with the function values plus randomly selected residuals.
+ *
+ * The sample must have the same size and positions as the data used to compute the model values and residuals.
+ * The sample is modified in place, so no memory is allocated.
+ */
+template <typename DataVector, typename RandomEngine>
+void resample_into(const std::vector<floating_t>& model_values, const std::vector<floating_t>& residuals,
+                   RandomEngine& gen, DataVector& sample) {
+    std::uniform_int_distribution<std::size_t> dist(0, residuals.size() - 1);
+    std::size_t i = 0;
+    for (auto& x : sample) {
+        x.out = model_values[i] + residuals[dist(gen)];
+        ++i;
+    }
+}
+
+/** @brief Overwrites the measured values in sample with the function values plus randomly selected residuals. */
+template <std::size_t InputDimensions, typename Scalar, typename RandomEngine>
+void resample_into(const std::vector<floating_t>& model_values, const std::vector<floating_t>& residuals,
+                   RandomEngine& gen, MeasurementColumns<InputDimensions, Scalar>& sample) {
+    std::uniform_int_distribution<std::size_t> dist(0, residuals.size() - 1);
+    for (std::size_t i = 0; i < sample.size(); ++i) {
+        sample.set_output(i, model_values[i] + residuals[dist(gen)]);
+    }
+}
+
+/** @brief Overwrites the measured values in sample with the function values plus randomly selected residuals.
+ * The values are stored in memory, the mapped file is not modified.
+ */
+template <std::size_t InputDimensions, typename RandomEngine>
+void resample_into(const std::vector<floating_t>& model_values, const std::vector<floating_t>& residuals,
+                   RandomEngine& gen, MappedMeasurementFile<InputDimensions>& sample) {
+    std::uniform_int_distribution<std::size_t> dist(0, residuals.size() - 1);
+    for (std::size_t i = 0; i < sample.size(); ++i) {
+        sample.set_output(i, model_values[i] + residuals[dist(gen)]);
+    }
+}
+
 /** compute mean */
 template <std::size_t NumberOfParameters>
 minimize::parameter_t<NumberOfParameters> compute_mean(
@@ -74,6 +157,53 @@ minimize::parameter_t<NumberOfParameters> compute_stddev(
     return elementwise_sqrt(variance);
 }
 
+/** compute the covariance matrix, normalized like compute_stddev() */
+template <std::size_t NumberOfParameters>
+minimize::matrix_t<NumberOfParameters> compute_covariance(
+    const std::vector<minimize::parameter_t<NumberOfParameters>>& values) {
+    const auto mean = compute_mean(values);
+    auto rv = zero_matrix<NumberOfParameters>();
+    for (const auto& v : values) {
+        for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+            for (std::size_t k = 0; k < NumberOfParameters; ++k) {
+                rv[i][k] += (v[i] - mean[i]) * (v[k] - mean[k]);
+            }
+        }
+    }
+    const floating_t scale = 1.0 / values.size();
+    for (auto& row : rv) {
+        row = detail::scale_vector(scale, row);
+    }
+    return rv;
+}
+
+/**
+ * @brief Estimates the covariance of the optimized parameters from the normal equations.
+ *
+ * The covariance is the inverse of J^T W J at the optimum, scaled by WSSR/NDF. This needs a single pass over
+ * the data. The results are not modified if there are no degrees of freedom or J^T W J is singular.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+void estimate_covariance_errors(const Function<InputDimensions, NumberOfParameters>& function,
+                                const DataVector& measurements, FitResults<NumberOfParameters>& results) {
+    if (measurements.size() <= NumberOfParameters) {
+        return;
+    }
+    auto system = compute_normal_equations(function, measurements, results.optimized_values());
+    if (!cholesky_decomposition(system.jtj)) {
+        return;
+    }
+    auto covariance = cholesky_inverse(system.jtj);
+    const auto scale = system.wssr / static_cast<floating_t>(measurements.size() - NumberOfParameters);
+    minimize::parameter_t<NumberOfParameters> errors;
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        covariance[i] = detail::scale_vector(scale, covariance[i]);
+        errors[i] = std::sqrt(covariance[i][i]);
+    }
+    results.set_covariance(covariance);
+    results.set_optimized_value_errors(errors);
+}
+
 }  // namespace detail
 
 } /* namespace minimize */
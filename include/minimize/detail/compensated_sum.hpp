@@ -0,0 +1,49 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_DETAIL_COMPENSATED_SUM_INCLUDED_HPP
+#define MINIMIZE_DETAIL_COMPENSATED_SUM_INCLUDED_HPP
+
+#include <cmath>
+
+#include "minimize/detail/meta.hpp"
+
+namespace minimize {
+
+namespace detail {
+
+/**
+ * @brief Sum with Neumaier compensation.
+ *
+ * The rounding error of every addition is collected in a second accumulator, so the error of the sum
+ * does not grow with the number of terms. Adding costs a few more operations than a plain sum, so the
+ * wssr only compensates the sums of whole batches of terms.
+ */
+class CompensatedSum {
+public:
+    void add(floating_t x) noexcept {
+        const floating_t t = sum_ + x;
+        if (std::fabs(sum_) >= std::fabs(x)) {
+            compensation_ += (sum_ - t) + x;
+        } else {
+            compensation_ += (x - t) + sum_;
+        }
+        sum_ = t;
+    }
+
+    void add(const CompensatedSum& other) noexcept {
+        add(other.sum_);
+        compensation_ += other.compensation_;
+    }
+
+    floating_t value() const noexcept { return sum_ + compensation_; }
+
+private:
+    floating_t sum_{0.0};
+    floating_t compensation_{0.0};
+};
+
+}  // namespace detail
+}  // namespace minimize
+
+#endif /* MINIMIZE_DETAIL_COMPENSATED_SUM_INCLUDED_HPP */
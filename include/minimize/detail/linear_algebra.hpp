@@ -0,0 +1,100 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_DETAIL_LINEAR_ALGEBRA_INCLUDED_HPP
+#define MINIMIZE_DETAIL_LINEAR_ALGEBRA_INCLUDED_HPP
+
+#include <cmath>
+
+#include "minimize/detail/meta.hpp"
+
+namespace minimize {
+
+namespace detail {
+
+/** Returns a matrix with all elements set to zero. */
+template <std::size_t NumberOfParameters>
+minimize::matrix_t<NumberOfParameters> zero_matrix() {
+    minimize::matrix_t<NumberOfParameters> rv;
+    for (auto& row : rv) {
+        row.fill(0.0);
+    }
+    return rv;
+}
+
+/**
+ * @brief Computes the Cholesky decomposition A = L * L^T of a symmetric matrix in place.
+ *
+ * Only the lower triangle of the input is read. On success, the lower triangle holds L.
+ *
+ * @param[in,out] a symmetric matrix, overwritten with L
+ * @return true if the matrix is positive definite, false otherwise
+ */
+template <std::size_t NumberOfParameters>
+bool cholesky_decomposition(minimize::matrix_t<NumberOfParameters>& a) {
+    for (std::size_t j = 0; j < NumberOfParameters; ++j) {
+        minimize::floating_t diagonal = a[j][j];
+        for (std::size_t k = 0; k < j; ++k) {
+            diagonal -= a[j][k] * a[j][k];
+        }
+        if (!(diagonal > 0.0)) {
+            return false;
+        }
+        a[j][j] = std::sqrt(diagonal);
+        for (std::size_t i = j + 1; i < NumberOfParameters; ++i) {
+            minimize::floating_t value = a[i][j];
+            for (std::size_t k = 0; k < j; ++k) {
+                value -= a[i][k] * a[j][k];
+            }
+            a[i][j] = value / a[j][j];
+        }
+    }
+    return true;
+}
+
+/** Solves L * L^T * x = b, where l is the output of cholesky_decomposition(). */
+template <std::size_t NumberOfParameters>
+minimize::parameter_t<NumberOfParameters> cholesky_solve(const minimize::matrix_t<NumberOfParameters>& l,
+                                                         const minimize::parameter_t<NumberOfParameters>& b) {
+    minimize::parameter_t<NumberOfParameters> y;
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        minimize::floating_t value = b[i];
+        for (std::size_t k = 0; k < i; ++k) {
+            value -= l[i][k] * y[k];
+        }
+        y[i] = value / l[i][i];
+    }
+    minimize::parameter_t<NumberOfParameters> x;
+    for (std::size_t i = NumberOfParameters; i-- > 0;) {
+        minimize::floating_t value = y[i];
+        for (std::size_t k = i + 1; k < NumberOfParameters; ++k) {
+            value -= l[k][i] * x[k];
+        }
+        x[i] = value / l[i][i];
+    }
+    return x;
+}
+
+/** Computes the inverse of L * L^T, where l is the output of cholesky_decomposition().
+ * The lower triangle is copied to the upper triangle, so the result is exactly symmetric.
+ */
+template <std::size_t NumberOfParameters>
+minimize::matrix_t<NumberOfParameters> cholesky_inverse(const minimize::matrix_t<NumberOfParameters>& l) {
+    minimize::matrix_t<NumberOfParameters> rv;
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        minimize::parameter_t<NumberOfParameters> unit;
+        unit.fill(0.0);
+        unit[i] = 1.0;
+        const auto column = cholesky_solve(l, unit);
+        for (std::size_t k = i; k < NumberOfParameters; ++k) {
+            rv[k][i] = column[k];
+            rv[i][k] = column[k];
+        }
+    }
+    return rv;
+}
+
+}  // namespace detail
+}  // namespace minimize
+
+#endif /* MINIMIZE_DETAIL_LINEAR_ALGEBRA_INCLUDED_HPP */
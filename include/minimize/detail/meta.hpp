@@ -14,6 +14,10 @@ using floating_t = double;
 template <std::size_t NumberOfParameters>
 using parameter_t = std::array<floating_t, NumberOfParameters>;
 
+/** Square matrix with one row per parameter, stored row by row. */
+template <std::size_t NumberOfParameters>
+using matrix_t = std::array<std::array<floating_t, NumberOfParameters>, NumberOfParameters>;
+
 namespace detail {
 
 template <std::size_t NumberOfParameters>
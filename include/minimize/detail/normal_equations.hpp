@@ -0,0 +1,100 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_DETAIL_NORMAL_EQUATIONS_INCLUDED_HPP
+#define MINIMIZE_DETAIL_NORMAL_EQUATIONS_INCLUDED_HPP
+
+#include "minimize/detail/linear_algebra.hpp"
+#include "minimize/function.hpp"
+#include "minimize/instrumentation.hpp"
+#include "minimize/measurement.hpp"
+#include "minimize/measurement_columns.hpp"
+
+namespace minimize {
+
+namespace detail {
+
+/** The weighted normal equations J^T W J and J^T W r of a least squares problem,
+ * together with the wssr at the same parameters.
+ */
+template <std::size_t NumberOfParameters>
+struct NormalEquations {
+    minimize::matrix_t<NumberOfParameters> jtj{};
+    minimize::parameter_t<NumberOfParameters> jtr{};
+    minimize::floating_t wssr{0.0};
+};
+
+/** Adds a single measurement to the lower triangle of J^T W J, to J^T W r and to the wssr. */
+template <std::size_t NumberOfParameters>
+void add_to_normal_equations(NormalEquations<NumberOfParameters>& system,
+                             const ValueAndGradient<NumberOfParameters>& value, minimize::floating_t measured,
+                             minimize::floating_t weight) {
+    const auto residual = value.value - measured;
+    system.wssr += weight * residual * residual;
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        const auto weighted_gradient = weight * value.gradient[i];
+        system.jtr[i] += weighted_gradient * residual;
+        for (std::size_t k = 0; k <= i; ++k) {
+            system.jtj[i][k] += weighted_gradient * value.gradient[k];
+        }
+    }
+}
+
+/** Copies the lower triangle of J^T W J to the upper triangle. */
+template <std::size_t NumberOfParameters>
+void symmetrize_normal_equations(NormalEquations<NumberOfParameters>& system) {
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        for (std::size_t k = i + 1; k < NumberOfParameters; ++k) {
+            system.jtj[i][k] = system.jtj[k][i];
+        }
+    }
+}
+
+/**
+ * @brief Assembles the normal equations in a single pass over the data.
+ *
+ * J is the jacobian of the function values w.r.t. the parameters, r the residuals
+ * f(x,p)-y and W the diagonal matrix of the measurement weights.
+ *
+ * @param fun Function to minimize
+ * @param vec Measured data
+ * @param par parameters for the function
+ * @return NormalEquations<NumberOfParameters>
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+NormalEquations<NumberOfParameters> compute_normal_equations(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                             const DataVector& vec,
+                                                             const parameter_t<NumberOfParameters>& par) {
+    NormalEquations<NumberOfParameters> rv;
+    rv.jtj = zero_matrix<NumberOfParameters>();
+    rv.jtr.fill(0.0);
+    record_gradient_evaluations(vec.size());
+    record_data_pass();
+    for (const auto& x : vec) {
+        add_to_normal_equations(rv, fun.evaluate_with_gradient(x.in, par), x.out, measurement_weight(x));
+    }
+    symmetrize_normal_equations(rv);
+    return rv;
+}
+
+/** Assembles the normal equations of data stored in columns in a single pass. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename Scalar>
+NormalEquations<NumberOfParameters> compute_normal_equations(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                             const MeasurementColumns<InputDimensions, Scalar>& vec,
+                                                             const parameter_t<NumberOfParameters>& par) {
+    NormalEquations<NumberOfParameters> rv;
+    rv.jtj = zero_matrix<NumberOfParameters>();
+    rv.jtr.fill(0.0);
+    record_gradient_evaluations(vec.size());
+    record_data_pass();
+    for (std::size_t i = 0; i < vec.size(); ++i) {
+        add_to_normal_equations(rv, fun.evaluate_with_gradient(vec.input_at(i), par), vec.output(i), vec.weight(i));
+    }
+    symmetrize_normal_equations(rv);
+    return rv;
+}
+
+}  // namespace detail
+}  // namespace minimize
+
+#endif /* MINIMIZE_DETAIL_NORMAL_EQUATIONS_INCLUDED_HPP */
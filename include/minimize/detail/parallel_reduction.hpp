@@ -0,0 +1,64 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_DETAIL_PARALLEL_REDUCTION_INCLUDED_HPP
+#define MINIMIZE_DETAIL_PARALLEL_REDUCTION_INCLUDED_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "minimize/detail/aligned_allocator.hpp"
+#include "minimize/thread_pool.hpp"
+
+namespace minimize {
+
+namespace detail {
+
+/** Number of data points that are reduced sequentially by one task of a parallel reduction.
+ * The chunks do not depend on the number of threads, so the results do not either.
+ */
+constexpr std::size_t reduction_chunk_size = 16384;
+
+/** A value that occupies at least a full cache line, so that neighbours written by other threads
+ * do not share the line.
+ */
+template <typename T>
+struct alignas(cache_line_size) CacheLinePadded {
+    T value;
+};
+
+/**
+ * @brief Reduces the range [0, size) in chunks of reduction_chunk_size on the global thread pool.
+ *
+ * reduce_chunk(begin, end) must return the partial result of the chunk [begin, end),
+ * combine(total, partial) adds a partial result to the total. The partial results are combined
+ * in the order of the chunks, so the result is the same for every thread count.
+ * A range with a single chunk is reduced directly in the calling thread.
+ *
+ * @param size number of elements
+ * @param reduce_chunk callable computing the partial result of a chunk
+ * @param combine callable adding a partial result to the total
+ */
+template <typename T, typename ChunkReduction, typename Combine>
+T reduce_in_chunks(std::size_t size, const ChunkReduction& reduce_chunk, const Combine& combine) {
+    const std::size_t chunks = (size + reduction_chunk_size - 1) / reduction_chunk_size;
+    if (chunks <= 1) {
+        return reduce_chunk(0, size);
+    }
+    std::vector<CacheLinePadded<T>, AlignedAllocator<CacheLinePadded<T>>> partial(chunks);
+    global_thread_pool().parallel_for(chunks, [&](std::size_t chunk, std::size_t) {
+        const std::size_t begin = chunk * reduction_chunk_size;
+        partial[chunk].value = reduce_chunk(begin, std::min(size, begin + reduction_chunk_size));
+    });
+    T rv = partial[0].value;
+    for (std::size_t i = 1; i < chunks; ++i) {
+        combine(rv, partial[i].value);
+    }
+    return rv;
+}
+
+}  // namespace detail
+}  // namespace minimize
+
+#endif /* MINIMIZE_DETAIL_PARALLEL_REDUCTION_INCLUDED_HPP */
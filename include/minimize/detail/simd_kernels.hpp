@@ -0,0 +1,365 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_DETAIL_SIMD_KERNELS_INCLUDED_HPP
+#define MINIMIZE_DETAIL_SIMD_KERNELS_INCLUDED_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+#include "minimize/detail/meta.hpp"
+
+/** Define as 0 to use only the portable kernels. */
+#ifndef MINIMIZE_ENABLE_SIMD
+#define MINIMIZE_ENABLE_SIMD 1
+#endif
+
+#if MINIMIZE_ENABLE_SIMD && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MINIMIZE_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define MINIMIZE_SIMD_X86 0
+#endif
+
+/** Keeps gcc from contracting the multiplications and additions of the kernels into fused multiply-adds,
+ * which are only available on some instruction sets and round differently.
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#define MINIMIZE_NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#define MINIMIZE_NO_FP_CONTRACT
+#endif
+
+namespace minimize {
+
+namespace detail {
+
+static_assert(std::is_same<floating_t, double>::value, "the simd kernels are written for double precision");
+
+/**
+ * The reductions accumulate element i into lane i % simd_lanes and add the lanes in a fixed order at the end.
+ * All instruction sets use the same lanes and the same order, so their results are bit identical.
+ */
+constexpr std::size_t simd_lanes = 8;
+
+/** Adds the lanes as ((l0 + l4) + (l2 + l6)) + ((l1 + l5) + (l3 + l7)), the order of the vector reductions. */
+MINIMIZE_NO_FP_CONTRACT inline floating_t reduce_lanes(const floating_t* lanes) noexcept {
+    const floating_t a0 = lanes[0] + lanes[4];
+    const floating_t a1 = lanes[1] + lanes[5];
+    const floating_t a2 = lanes[2] + lanes[6];
+    const floating_t a3 = lanes[3] + lanes[7];
+    return (a0 + a2) + (a1 + a3);
+}
+
+/** Portable kernels. The arithmetic per element is the same as in the vector kernels. */
+struct ScalarKernels {
+    MINIMIZE_NO_FP_CONTRACT static floating_t sum(const floating_t* x, std::size_t n) noexcept {
+        floating_t lanes[simd_lanes] = {};
+        for (std::size_t i = 0; i < n; ++i) {
+            lanes[i % simd_lanes] += x[i];
+        }
+        return reduce_lanes(lanes);
+    }
+
+    MINIMIZE_NO_FP_CONTRACT static floating_t sum_squared_differences(const floating_t* values,
+                                                                      const floating_t* outputs,
+                                                                      std::size_t n) noexcept {
+        floating_t lanes[simd_lanes] = {};
+        for (std::size_t i = 0; i < n; ++i) {
+            const floating_t diff = values[i] - outputs[i];
+            lanes[i % simd_lanes] += diff * diff;
+        }
+        return reduce_lanes(lanes);
+    }
+
+    MINIMIZE_NO_FP_CONTRACT static floating_t sum_weighted_squared_differences(
+        const floating_t* values, const floating_t* outputs, const floating_t* weights, std::size_t n) noexcept {
+        floating_t lanes[simd_lanes] = {};
+        for (std::size_t i = 0; i < n; ++i) {
+            const floating_t diff = values[i] - outputs[i];
+            lanes[i % simd_lanes] += weights[i] * diff * diff;
+        }
+        return reduce_lanes(lanes);
+    }
+
+    MINIMIZE_NO_FP_CONTRACT static void add_scaled_rows(floating_t* out, const floating_t* factors,
+                                                        const floating_t* rows, std::size_t count,
+                                                        std::size_t columns) noexcept {
+        for (std::size_t i = 0; i < count; ++i) {
+            const floating_t* row = rows + i * columns;
+            for (std::size_t p = 0; p < columns; ++p) {
+                out[p] += factors[i] * row[p];
+            }
+        }
+    }
+};
+
+#if MINIMIZE_SIMD_X86
+
+#define MINIMIZE_TARGET_SSE2 MINIMIZE_NO_FP_CONTRACT __attribute__((target("sse2")))
+#define MINIMIZE_TARGET_AVX2 MINIMIZE_NO_FP_CONTRACT __attribute__((target("avx2")))
+#define MINIMIZE_TARGET_AVX512 MINIMIZE_NO_FP_CONTRACT __attribute__((target("avx512f")))
+
+/** Kernels with SSE2, two lanes per register. */
+struct Sse2Kernels {
+    MINIMIZE_TARGET_SSE2 static floating_t finish(__m128d r0, __m128d r1, __m128d r2, __m128d r3,
+                                                  const floating_t* tail, std::size_t count) noexcept {
+        floating_t lanes[simd_lanes];
+        _mm_storeu_pd(lanes, r0);
+        _mm_storeu_pd(lanes + 2, r1);
+        _mm_storeu_pd(lanes + 4, r2);
+        _mm_storeu_pd(lanes + 6, r3);
+        for (std::size_t i = 0; i < count; ++i) {
+            lanes[i] += tail[i];
+        }
+        return reduce_lanes(lanes);
+    }
+
+    MINIMIZE_TARGET_SSE2 static floating_t sum(const floating_t* x, std::size_t n) noexcept {
+        __m128d r0 = _mm_setzero_pd(), r1 = _mm_setzero_pd(), r2 = _mm_setzero_pd(), r3 = _mm_setzero_pd();
+        const std::size_t full = n - n % simd_lanes;
+        for (std::size_t i = 0; i < full; i += simd_lanes) {
+            r0 = _mm_add_pd(r0, _mm_loadu_pd(x + i));
+            r1 = _mm_add_pd(r1, _mm_loadu_pd(x + i + 2));
+            r2 = _mm_add_pd(r2, _mm_loadu_pd(x + i + 4));
+            r3 = _mm_add_pd(r3, _mm_loadu_pd(x + i + 6));
+        }
+        return finish(r0, r1, r2, r3, x + full, n - full);
+    }
+
+    MINIMIZE_TARGET_SSE2 static __m128d squared_difference(const floating_t* values,
+                                                           const floating_t* outputs) noexcept {
+        const __m128d diff = _mm_sub_pd(_mm_loadu_pd(values), _mm_loadu_pd(outputs));
+        return _mm_mul_pd(diff, diff);
+    }
+
+    MINIMIZE_TARGET_SSE2 static __m128d weighted_squared_difference(
+        const floating_t* values, const floating_t* outputs, const floating_t* weights) noexcept {
+        const __m128d diff = _mm_sub_pd(_mm_loadu_pd(values), _mm_loadu_pd(outputs));
+        return _mm_mul_pd(_mm_mul_pd(_mm_loadu_pd(weights), diff), diff);
+    }
+
+    MINIMIZE_TARGET_SSE2 static floating_t sum_squared_differences(const floating_t* values, const floating_t* outputs,
+                                                                   std::size_t n) noexcept {
+        __m128d r0 = _mm_setzero_pd(), r1 = _mm_setzero_pd(), r2 = _mm_setzero_pd(), r3 = _mm_setzero_pd();
+        const std::size_t full = n - n % simd_lanes;
+        for (std::size_t i = 0; i < full; i += simd_lanes) {
+            r0 = _mm_add_pd(r0, squared_difference(values + i, outputs + i));
+            r1 = _mm_add_pd(r1, squared_difference(values + i + 2, outputs + i + 2));
+            r2 = _mm_add_pd(r2, squared_difference(values + i + 4, outputs + i + 4));
+            r3 = _mm_add_pd(r3, squared_difference(values + i + 6, outputs + i + 6));
+        }
+        floating_t tail[simd_lanes];
+        for (std::size_t i = full; i < n; ++i) {
+            const floating_t diff = values[i] - outputs[i];
+            tail[i - full] = diff * diff;
+        }
+        return finish(r0, r1, r2, r3, tail, n - full);
+    }
+
+    MINIMIZE_TARGET_SSE2 static floating_t sum_weighted_squared_differences(
+        const floating_t* values, const floating_t* outputs, const floating_t* weights, std::size_t n) noexcept {
+        __m128d r0 = _mm_setzero_pd(), r1 = _mm_setzero_pd(), r2 = _mm_setzero_pd(), r3 = _mm_setzero_pd();
+        const std::size_t full = n - n % simd_lanes;
+        for (std::size_t i = 0; i < full; i += simd_lanes) {
+            r0 = _mm_add_pd(r0, weighted_squared_difference(values + i, outputs + i, weights + i));
+            r1 = _mm_add_pd(r1, weighted_squared_difference(values + i + 2, outputs + i + 2, weights + i + 2));
+            r2 = _mm_add_pd(r2, weighted_squared_difference(values + i + 4, outputs + i + 4, weights + i + 4));
+            r3 = _mm_add_pd(r3, weighted_squared_difference(values + i + 6, outputs + i + 6, weights + i + 6));
+        }
+        floating_t tail[simd_lanes];
+        for (std::size_t i = full; i < n; ++i) {
+            const floating_t diff = values[i] - outputs[i];
+            tail[i - full] = weights[i] * diff * diff;
+        }
+        return finish(r0, r1, r2, r3, tail, n - full);
+    }
+
+    MINIMIZE_TARGET_SSE2 static void add_scaled_rows(floating_t* out, const floating_t* factors, const floating_t* rows,
+                                                     std::size_t count, std::size_t columns) noexcept {
+        const std::size_t full = columns - columns % 2;
+        for (std::size_t i = 0; i < count; ++i) {
+            const floating_t* row = rows + i * columns;
+            const __m128d factor = _mm_set1_pd(factors[i]);
+            for (std::size_t p = 0; p < full; p += 2) {
+                _mm_storeu_pd(out + p,
+                              _mm_add_pd(_mm_loadu_pd(out + p), _mm_mul_pd(factor, _mm_loadu_pd(row + p))));
+            }
+            for (std::size_t p = full; p < columns; ++p) {
+                out[p] += factors[i] * row[p];
+            }
+        }
+    }
+};
+
+/** Kernels with AVX2, four lanes per register. */
+struct Avx2Kernels {
+    MINIMIZE_TARGET_AVX2 static floating_t finish(__m256d r0, __m256d r1, const floating_t* tail,
+                                                  std::size_t count) noexcept {
+        floating_t lanes[simd_lanes];
+        _mm256_storeu_pd(lanes, r0);
+        _mm256_storeu_pd(lanes + 4, r1);
+        for (std::size_t i = 0; i < count; ++i) {
+            lanes[i] += tail[i];
+        }
+        return reduce_lanes(lanes);
+    }
+
+    MINIMIZE_TARGET_AVX2 static floating_t sum(const floating_t* x, std::size_t n) noexcept {
+        __m256d r0 = _mm256_setzero_pd(), r1 = _mm256_setzero_pd();
+        const std::size_t full = n - n % simd_lanes;
+        for (std::size_t i = 0; i < full; i += simd_lanes) {
+            r0 = _mm256_add_pd(r0, _mm256_loadu_pd(x + i));
+            r1 = _mm256_add_pd(r1, _mm256_loadu_pd(x + i + 4));
+        }
+        return finish(r0, r1, x + full, n - full);
+    }
+
+    MINIMIZE_TARGET_AVX2 static __m256d squared_difference(const floating_t* values,
+                                                           const floating_t* outputs) noexcept {
+        const __m256d diff = _mm256_sub_pd(_mm256_loadu_pd(values), _mm256_loadu_pd(outputs));
+        return _mm256_mul_pd(diff, diff);
+    }
+
+    MINIMIZE_TARGET_AVX2 static __m256d weighted_squared_difference(
+        const floating_t* values, const floating_t* outputs, const floating_t* weights) noexcept {
+        const __m256d diff = _mm256_sub_pd(_mm256_loadu_pd(values), _mm256_loadu_pd(outputs));
+        return _mm256_mul_pd(_mm256_mul_pd(_mm256_loadu_pd(weights), diff), diff);
+    }
+
+    MINIMIZE_TARGET_AVX2 static floating_t sum_squared_differences(const floating_t* values, const floating_t* outputs,
+                                                                   std::size_t n) noexcept {
+        __m256d r0 = _mm256_setzero_pd(), r1 = _mm256_setzero_pd();
+        const std::size_t full = n - n % simd_lanes;
+        for (std::size_t i = 0; i < full; i += simd_lanes) {
+            r0 = _mm256_add_pd(r0, squared_difference(values + i, outputs + i));
+            r1 = _mm256_add_pd(r1, squared_difference(values + i + 4, outputs + i + 4));
+        }
+        floating_t tail[simd_lanes];
+        for (std::size_t i = full; i < n; ++i) {
+            const floating_t diff = values[i] - outputs[i];
+            tail[i - full] = diff * diff;
+        }
+        return finish(r0, r1, tail, n - full);
+    }
+
+    MINIMIZE_TARGET_AVX2 static floating_t sum_weighted_squared_differences(
+        const floating_t* values, const floating_t* outputs, const floating_t* weights, std::size_t n) noexcept {
+        __m256d r0 = _mm256_setzero_pd(), r1 = _mm256_setzero_pd();
+        const std::size_t full = n - n % simd_lanes;
+        for (std::size_t i = 0; i < full; i += simd_lanes) {
+            r0 = _mm256_add_pd(r0, weighted_squared_difference(values + i, outputs + i, weights + i));
+            r1 = _mm256_add_pd(r1, weighted_squared_difference(values + i + 4, outputs + i + 4, weights + i + 4));
+        }
+        floating_t tail[simd_lanes];
+        for (std::size_t i = full; i < n; ++i) {
+            const floating_t diff = values[i] - outputs[i];
+            tail[i - full] = weights[i] * diff * diff;
+        }
+        return finish(r0, r1, tail, n - full);
+    }
+
+    MINIMIZE_TARGET_AVX2 static void add_scaled_rows(floating_t* out, const floating_t* factors, const floating_t* rows,
+                                                     std::size_t count, std::size_t columns) noexcept {
+        const std::size_t full = columns - columns % 4;
+        for (std::size_t i = 0; i < count; ++i) {
+            const floating_t* row = rows + i * columns;
+            const __m256d factor = _mm256_set1_pd(factors[i]);
+            for (std::size_t p = 0; p < full; p += 4) {
+                _mm256_storeu_pd(out + p, _mm256_add_pd(_mm256_loadu_pd(out + p),
+                                                        _mm256_mul_pd(factor, _mm256_loadu_pd(row + p))));
+            }
+            for (std::size_t p = full; p < columns; ++p) {
+                out[p] += factors[i] * row[p];
+            }
+        }
+    }
+};
+
+/** Kernels with AVX-512, all eight lanes in one register. */
+struct Avx512Kernels {
+    MINIMIZE_TARGET_AVX512 static floating_t finish(__m512d r, const floating_t* tail, std::size_t count) noexcept {
+        floating_t lanes[simd_lanes];
+        _mm512_storeu_pd(lanes, r);
+        for (std::size_t i = 0; i < count; ++i) {
+            lanes[i] += tail[i];
+        }
+        return reduce_lanes(lanes);
+    }
+
+    MINIMIZE_TARGET_AVX512 static floating_t sum(const floating_t* x, std::size_t n) noexcept {
+        __m512d r = _mm512_setzero_pd();
+        const std::size_t full = n - n % simd_lanes;
+        for (std::size_t i = 0; i < full; i += simd_lanes) {
+            r = _mm512_add_pd(r, _mm512_loadu_pd(x + i));
+        }
+        return finish(r, x + full, n - full);
+    }
+
+    MINIMIZE_TARGET_AVX512 static floating_t sum_squared_differences(const floating_t* values,
+                                                                     const floating_t* outputs,
+                                                                     std::size_t n) noexcept {
+        __m512d r = _mm512_setzero_pd();
+        const std::size_t full = n - n % simd_lanes;
+        for (std::size_t i = 0; i < full; i += simd_lanes) {
+            const __m512d diff = _mm512_sub_pd(_mm512_loadu_pd(values + i), _mm512_loadu_pd(outputs + i));
+            r = _mm512_add_pd(r, _mm512_mul_pd(diff, diff));
+        }
+        floating_t tail[simd_lanes];
+        for (std::size_t i = full; i < n; ++i) {
+            const floating_t diff = values[i] - outputs[i];
+            tail[i - full] = diff * diff;
+        }
+        return finish(r, tail, n - full);
+    }
+
+    MINIMIZE_TARGET_AVX512 static floating_t sum_weighted_squared_differences(
+        const floating_t* values, const floating_t* outputs, const floating_t* weights, std::size_t n) noexcept {
+        __m512d r = _mm512_setzero_pd();
+        const std::size_t full = n - n % simd_lanes;
+        for (std::size_t i = 0; i < full; i += simd_lanes) {
+            const __m512d diff = _mm512_sub_pd(_mm512_loadu_pd(values + i), _mm512_loadu_pd(outputs + i));
+            r = _mm512_add_pd(r, _mm512_mul_pd(_mm512_mul_pd(_mm512_loadu_pd(weights + i), diff), diff));
+        }
+        floating_t tail[simd_lanes];
+        for (std::size_t i = full; i < n; ++i) {
+            const floating_t diff = values[i] - outputs[i];
+            tail[i - full] = weights[i] * diff * diff;
+        }
+        return finish(r, tail, n - full);
+    }
+
+    MINIMIZE_TARGET_AVX512 static void add_scaled_rows(floating_t* out, const floating_t* factors,
+                                                       const floating_t* rows, std::size_t count,
+                                                       std::size_t columns) noexcept {
+        const std::size_t full = columns - columns % 8;
+        const std::size_t half = columns - columns % 4;
+        for (std::size_t i = 0; i < count; ++i) {
+            const floating_t* row = rows + i * columns;
+            const __m512d factor = _mm512_set1_pd(factors[i]);
+            for (std::size_t p = 0; p < full; p += 8) {
+                _mm512_storeu_pd(out + p, _mm512_add_pd(_mm512_loadu_pd(out + p),
+                                                        _mm512_mul_pd(factor, _mm512_loadu_pd(row + p))));
+            }
+            if (full < half) {
+                const __m256d quarter = _mm256_set1_pd(factors[i]);
+                _mm256_storeu_pd(out + full, _mm256_add_pd(_mm256_loadu_pd(out + full),
+                                                           _mm256_mul_pd(quarter, _mm256_loadu_pd(row + full))));
+            }
+            for (std::size_t p = half; p < columns; ++p) {
+                out[p] += factors[i] * row[p];
+            }
+        }
+    }
+};
+
+#undef MINIMIZE_TARGET_SSE2
+#undef MINIMIZE_TARGET_AVX2
+#undef MINIMIZE_TARGET_AVX512
+
+#endif
+
+}  // namespace detail
+}  // namespace minimize
+
+#endif /* MINIMIZE_DETAIL_SIMD_KERNELS_INCLUDED_HPP */
@@ -76,6 +76,17 @@ std::array<minimize::floating_t, NumberOfParameters> scale_vector(
     return rv;
 }
 
+/** Scalar product of x and y. */
+template <std::size_t NumberOfParameters>
+minimize::floating_t dot(const std::array<minimize::floating_t, NumberOfParameters>& x,
+                         const std::array<minimize::floating_t, NumberOfParameters>& y) {
+    minimize::floating_t rv = 0.0;
+    for (size_t i = 0; i < NumberOfParameters; ++i) {
+        rv += x[i] * y[i];
+    }
+    return rv;
+}
+
 }  // namespace detail
 }  // namespace minimize
 
@@ -0,0 +1,230 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_DUAL_INCLUDED_HPP
+#define MINIMIZE_DUAL_INCLUDED_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include "minimize/detail/meta.hpp"
+
+namespace minimize {
+
+/**
+ * @brief Dual number for forward mode automatic differentiation.
+ *
+ * Holds a value and the derivatives of this value w.r.t. NumberOfDerivatives variables.
+ * All arithmetic operators and the common math functions apply the chain rule, so evaluating
+ * an expression with dual numbers yields its value and its exact gradient at the same time.
+ *
+ * Generic code should call the math functions unqualified after `using std::exp;` etc.,
+ * so that the overloads for Dual are found via argument dependent lookup.
+ */
+template <std::size_t NumberOfDerivatives>
+struct Dual {
+    using derivative_t = std::array<floating_t, NumberOfDerivatives>;
+
+    floating_t value{0.0};
+    derivative_t derivatives{};
+
+    Dual() = default;
+
+    /** A constant: all derivatives are zero. */
+    Dual(floating_t v) : value(v) { derivatives.fill(0.0); }
+
+    Dual(floating_t v, const derivative_t& d) : value(v), derivatives(d) {}
+
+    /** The independent variable with the given index: the derivative w.r.t. itself is one. */
+    static Dual variable(floating_t v, std::size_t index) {
+        Dual rv(v);
+        rv.derivatives[index] = 1.0;
+        return rv;
+    }
+
+    Dual& operator+=(const Dual& o) {
+        value += o.value;
+        for (std::size_t i = 0; i < NumberOfDerivatives; ++i) {
+            derivatives[i] += o.derivatives[i];
+        }
+        return *this;
+    }
+
+    Dual& operator-=(const Dual& o) {
+        value -= o.value;
+        for (std::size_t i = 0; i < NumberOfDerivatives; ++i) {
+            derivatives[i] -= o.derivatives[i];
+        }
+        return *this;
+    }
+
+    Dual& operator*=(const Dual& o) {
+        for (std::size_t i = 0; i < NumberOfDerivatives; ++i) {
+            derivatives[i] = derivatives[i] * o.value + value * o.derivatives[i];
+        }
+        value *= o.value;
+        return *this;
+    }
+
+    Dual& operator/=(const Dual& o) {
+        const floating_t inverse = 1.0 / o.value;
+        value *= inverse;
+        for (std::size_t i = 0; i < NumberOfDerivatives; ++i) {
+            derivatives[i] = (derivatives[i] - value * o.derivatives[i]) * inverse;
+        }
+        return *this;
+    }
+
+    Dual& operator+=(floating_t o) {
+        value += o;
+        return *this;
+    }
+
+    Dual& operator-=(floating_t o) {
+        value -= o;
+        return *this;
+    }
+
+    Dual& operator*=(floating_t o) {
+        value *= o;
+        for (auto& d : derivatives) {
+            d *= o;
+        }
+        return *this;
+    }
+
+    Dual& operator/=(floating_t o) { return *this *= 1.0 / o; }
+};
+
+namespace detail {
+
+/** Applies the chain rule for a function with value f and derivative df at the value of x. */
+template <std::size_t N>
+Dual<N> chain_rule(const Dual<N>& x, floating_t f, floating_t df) {
+    Dual<N> rv(f);
+    for (std::size_t i = 0; i < N; ++i) {
+        rv.derivatives[i] = df * x.derivatives[i];
+    }
+    return rv;
+}
+
+}  // namespace detail
+
+template <std::size_t N>
+Dual<N> operator+(const Dual<N>& x) {
+    return x;
+}
+
+template <std::size_t N>
+Dual<N> operator-(const Dual<N>& x) {
+    return detail::chain_rule(x, -x.value, -1.0);
+}
+
+#define MINIMIZE_DUAL_BINARY_OPERATOR(op)                          \
+    template <std::size_t N>                                       \
+    Dual<N> operator op(Dual<N> lhs, const Dual<N>& rhs) {         \
+        return lhs op## = rhs;                                     \
+    }                                                              \
+    template <std::size_t N>                                       \
+    Dual<N> operator op(Dual<N> lhs, floating_t rhs) {             \
+        return lhs op## = rhs;                                     \
+    }                                                              \
+    template <std::size_t N>                                       \
+    Dual<N> operator op(floating_t lhs, const Dual<N>& rhs) {      \
+        return Dual<N>(lhs) op## = rhs;                            \
+    }
+
+MINIMIZE_DUAL_BINARY_OPERATOR(+)
+MINIMIZE_DUAL_BINARY_OPERATOR(-)
+MINIMIZE_DUAL_BINARY_OPERATOR(*)
+MINIMIZE_DUAL_BINARY_OPERATOR(/)
+
+#undef MINIMIZE_DUAL_BINARY_OPERATOR
+
+/** Comparisons only use the values. */
+#define MINIMIZE_DUAL_COMPARISON(op)                                 \
+    template <std::size_t N>                                         \
+    bool operator op(const Dual<N>& lhs, const Dual<N>& rhs) {       \
+        return lhs.value op rhs.value;                               \
+    }                                                                \
+    template <std::size_t N>                                         \
+    bool operator op(const Dual<N>& lhs, floating_t rhs) {           \
+        return lhs.value op rhs;                                     \
+    }                                                                \
+    template <std::size_t N>                                         \
+    bool operator op(floating_t lhs, const Dual<N>& rhs) {           \
+        return lhs op rhs.value;                                     \
+    }
+
+MINIMIZE_DUAL_COMPARISON(<)
+MINIMIZE_DUAL_COMPARISON(>)
+MINIMIZE_DUAL_COMPARISON(<=)
+MINIMIZE_DUAL_COMPARISON(>=)
+MINIMIZE_DUAL_COMPARISON(==)
+MINIMIZE_DUAL_COMPARISON(!=)
+
+#undef MINIMIZE_DUAL_COMPARISON
+
+template <std::size_t N>
+Dual<N> exp(const Dual<N>& x) {
+    const auto e = std::exp(x.value);
+    return detail::chain_rule(x, e, e);
+}
+
+template <std::size_t N>
+Dual<N> log(const Dual<N>& x) {
+    return detail::chain_rule(x, std::log(x.value), 1.0 / x.value);
+}
+
+template <std::size_t N>
+Dual<N> sqrt(const Dual<N>& x) {
+    const auto s = std::sqrt(x.value);
+    return detail::chain_rule(x, s, 0.5 / s);
+}
+
+template <std::size_t N>
+Dual<N> pow(const Dual<N>& x, floating_t exponent) {
+    // x^0 is constant, e * x^(e-1) would be 0 * inf at x = 0
+    if (exponent == 0.0) {
+        return detail::chain_rule(x, 1.0, 0.0);
+    }
+    // the value uses std::pow directly, the derivative e * x^(e-1) is infinite at x = 0 for e < 1
+    return detail::chain_rule(x, std::pow(x.value, exponent), exponent * std::pow(x.value, exponent - 1.0));
+}
+
+template <std::size_t N>
+Dual<N> sin(const Dual<N>& x) {
+    return detail::chain_rule(x, std::sin(x.value), std::cos(x.value));
+}
+
+template <std::size_t N>
+Dual<N> cos(const Dual<N>& x) {
+    return detail::chain_rule(x, std::cos(x.value), -std::sin(x.value));
+}
+
+template <std::size_t N>
+Dual<N> tan(const Dual<N>& x) {
+    const auto t = std::tan(x.value);
+    return detail::chain_rule(x, t, 1.0 + t * t);
+}
+
+template <std::size_t N>
+Dual<N> atan(const Dual<N>& x) {
+    return detail::chain_rule(x, std::atan(x.value), 1.0 / (1.0 + x.value * x.value));
+}
+
+template <std::size_t N>
+Dual<N> tanh(const Dual<N>& x) {
+    const auto t = std::tanh(x.value);
+    return detail::chain_rule(x, t, 1.0 - t * t);
+}
+
+template <std::size_t N>
+Dual<N> abs(const Dual<N>& x) {
+    return x.value < 0.0 ? -x : x;
+}
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_DUAL_INCLUDED_HPP */
@@ -4,6 +4,9 @@
 #ifndef MINIMIZE_FIND_MINIMUM_ON_LINE_INCLUDED_HPP
 #define MINIMIZE_FIND_MINIMUM_ON_LINE_INCLUDED_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <utility>
 
 #include "minimize/detail/vector_math.hpp"
@@ -13,16 +16,127 @@
 
 namespace minimize {
 
+/** Two points on a search line that bracket a minimum of the wssr. */
 template <std::size_t InputDimensions>
 struct Interval {
     parameter_t<InputDimensions> before;
     parameter_t<InputDimensions> past;
+    /** wssr at before. */
+    minimize::floating_t before_wssr;
+    /** wssr at past. */
+    minimize::floating_t past_wssr;
+    /** Number of passes over the data of the search. */
+    std::size_t evaluations;
 };
 
+/** Point found by the line search. */
+template <std::size_t NumberOfParameters>
+struct LineMinimum {
+    parameter_t<NumberOfParameters> parameters;
+    /** wssr at parameters. */
+    minimize::floating_t wssr;
+    /** Number of passes over the data of the search. */
+    std::size_t evaluations;
+};
+
+namespace detail {
+
+/** Number of points whose wssr is computed in one pass over the data by the line search. */
+constexpr std::size_t line_search_probes = 4;
+
+/**
+ * @brief Bisection step of binary_search_minimum_in_interval() with the wssr of lower, upper and mid already known.
+ *
+ * The search ends as soon as the middle is not below the mean of the bounds, so the new middle points are
+ * rejection probes computed with compute_wssr_bounded().
+ *
+ * @param evaluations passes over the data that were needed to compute the known wssr values
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+LineMinimum<NumberOfParameters> refine_minimum_in_interval(
+    const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+    parameter_t<NumberOfParameters> lower, minimize::floating_t lower_wssr, parameter_t<NumberOfParameters> upper,
+    minimize::floating_t upper_wssr, parameter_t<NumberOfParameters> mid, minimize::floating_t mid_wssr,
+    std::size_t max_iterations, std::size_t evaluations) {
+    const minimize::floating_t half = 0.5;
+    const minimize::floating_t quarter = 0.25;
+    std::size_t iterations = 0;
+    std::array<parameter_t<NumberOfParameters>, 3> points;
+    std::array<minimize::floating_t, 3> wssr;
+    while (true) {
+        if (mid_wssr == 0) {
+            return {mid, mid_wssr, evaluations};
+        }
+
+        const minimize::floating_t parabola_opening = (lower_wssr + upper_wssr) * half - mid_wssr;
+        const minimize::floating_t parabola_vertex = quarter * ((lower_wssr - upper_wssr) / parabola_opening);
+
+        bool new_bounds = false;
+        if (parabola_opening > 0) {
+            if (parabola_vertex < 0) {
+                upper = mid;
+                upper_wssr = mid_wssr;
+            } else if (parabola_vertex > 0) {
+                lower = mid;
+                lower_wssr = mid_wssr;
+            } else {
+                // special case - only happens if lower_wssr==upper_wssr and mid_wssr<upper_wssr
+                // reduce interval on both sides by an asymmetric amount
+                const auto tmp = detail::lerp(0.01, lower, upper);
+                const auto tmp2 = detail::lerp(0.98, lower, upper);
+                lower = tmp;
+                upper = tmp2;
+                new_bounds = true;
+            }
+        } else {
+            // special case - middle has worse wssr than outer positions
+            // we are done.
+            break;
+        }
+        ++iterations;
+        if (iterations >= max_iterations) {
+            if (new_bounds) {
+                points[0] = lower;
+                points[1] = upper;
+                compute_wssr_multi(fun, vec, points.data(), 2, wssr.data());
+                ++evaluations;
+                lower_wssr = wssr[0];
+                upper_wssr = wssr[1];
+            }
+            break;
+        }
+        mid = detail::lerp(0.5, lower, upper);
+        if (new_bounds) {
+            points = {{lower, upper, mid}};
+            compute_wssr_multi(fun, vec, points.data(), points.size(), wssr.data());
+            lower_wssr = wssr[0];
+            upper_wssr = wssr[1];
+            mid_wssr = wssr[2];
+        } else {
+            // the search ends if mid is not below the mean of the bounds, its exact wssr is not needed then
+            mid_wssr = compute_wssr_bounded(fun, vec, mid, (lower_wssr + upper_wssr) * half);
+        }
+        ++evaluations;
+    }
+    if (lower_wssr < upper_wssr) {
+        return {lower, lower_wssr, evaluations};
+    } else {
+        return {upper, upper_wssr, evaluations};
+    }
+}
+
+}  // namespace detail
+
 /** This method searches a point that is just past the minimum in the parameter space of a function.
+ *
+ * The steps grow geometrically. The wssr of detail::line_search_probes steps is computed in a single pass over
+ * the data. The steps after the first one with a larger wssr than before the pass are dropped early, see
+ * compute_wssr_multi_bounded(). The returned interval holds the wssr at both ends, so the following binary search
+ * does not have to compute them again.
  *
  * @param[in] fun function to search the minimum
  * @param[in] par parameters for the function
+ * @param[in] start_wssr wssr at par, usually known by the solver
  * @param[in] vec measured data points
  * @param[in] direction direction of the search in the parameter space
  * @param[in] max_iterations limit for the iterations in the search
@@ -30,35 +144,62 @@ struct Interval {
 template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
 Interval<NumberOfParameters> search_interval_around_minimum(const Function<InputDimensions, NumberOfParameters>& fun,
                                                             const parameter_t<NumberOfParameters>& par,
-                                                            const DataVector& vec,
+                                                            minimize::floating_t start_wssr, const DataVector& vec,
                                                             const parameter_t<NumberOfParameters>& direction,
                                                             std::size_t max_iterations) {
+    constexpr std::size_t probes = detail::line_search_probes;
+    const std::size_t limit = std::max<std::size_t>(1, max_iterations);
+    std::array<parameter_t<NumberOfParameters>, probes> candidates;
+    std::array<minimize::floating_t, probes> wssr;
     std::size_t iterations = 0;
+    std::size_t evaluations = 0;
     parameter_t<NumberOfParameters> before = par;
     parameter_t<NumberOfParameters> mid = par;
-    parameter_t<NumberOfParameters> past;
-    minimize::floating_t last_wssr = compute_wssr(fun, vec, par);
-    bool is_smaller = true;
+    minimize::floating_t before_wssr = start_wssr;
+    minimize::floating_t mid_wssr = start_wssr;
+    minimize::floating_t last_wssr = start_wssr;
     minimize::floating_t current_position = 0.01;
     const minimize::floating_t scale_factor = 1.618;
-    do {
-        past = detail::axpy(-current_position, direction, par);
-        const minimize::floating_t next_wssr = compute_wssr(fun, vec, past);
-        is_smaller = next_wssr < last_wssr;
-        // We assume a single global minimum along this direction.
-        // On step x we may step past the minimum, but the wssr is still smaller than
-        // in the previous iteration. So returning p[i-1],p[i] as interval may not include
-        // the minimum. Returning p[i-2],p[i] fixes this problem.
-        if (is_smaller) {
-            before = mid;
-            mid = past;
+    while (true) {
+        std::size_t count = 0;
+        for (; count < probes && iterations + count < limit; ++count) {
+            candidates[count] = detail::axpy(-current_position, direction, par);
+            current_position *= scale_factor;
         }
-        last_wssr = next_wssr;
-        current_position *= scale_factor;
-        ++iterations;
-    } while (iterations < max_iterations && is_smaller);
+        // the search ends at the first step that is not smaller than its predecessor, the steps after it are
+        // dropped as soon as it is known
+        compute_wssr_multi_bounded(fun, vec, candidates.data(), count, last_wssr, wssr.data());
+        ++evaluations;
+        for (std::size_t i = 0; i < count; ++i) {
+            const bool is_smaller = wssr[i] < last_wssr;
+            // We assume a single global minimum along this direction.
+            // On step x we may step past the minimum, but the wssr is still smaller than
+            // in the previous iteration. So returning p[i-1],p[i] as interval may not include
+            // the minimum. Returning p[i-2],p[i] fixes this problem.
+            if (is_smaller) {
+                before = mid;
+                before_wssr = mid_wssr;
+                mid = candidates[i];
+                mid_wssr = wssr[i];
+            }
+            last_wssr = wssr[i];
+            ++iterations;
+            if (!is_smaller || iterations >= limit) {
+                return {before, candidates[i], before_wssr, wssr[i], evaluations};
+            }
+        }
+    }
+}
 
-    return {before, past};
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+Interval<NumberOfParameters> search_interval_around_minimum(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                            const parameter_t<NumberOfParameters>& par,
+                                                            const DataVector& vec,
+                                                            const parameter_t<NumberOfParameters>& direction,
+                                                            std::size_t max_iterations) {
+    auto rv = search_interval_around_minimum(fun, par, compute_wssr(fun, vec, par), vec, direction, max_iterations);
+    ++rv.evaluations;
+    return rv;
 }
 
 template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
@@ -69,6 +210,28 @@ Interval<NumberOfParameters> search_interval_around_minimum(const Function<Input
     return search_interval_around_minimum(fun, fun.parameters(), vec, direction, max_iterations);
 }
 
+/**
+ * @brief Performs a binary search in an interval found by search_interval_around_minimum().
+ *
+ * The wssr at the ends of the interval is taken from the interval, so the search starts with a single pass
+ * over the data for the middle. See the overload below for the algorithm.
+ *
+ * @param fun Function to minimize
+ * @param vec Measured data
+ * @param interval bounds of the search with their wssr
+ * @param max_iterations iteration limit
+ * @return the minimum with its wssr and the passes over the data of the binary search
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+LineMinimum<NumberOfParameters> binary_search_minimum_in_interval(
+    const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+    const Interval<NumberOfParameters>& interval, std::size_t max_iterations) {
+    const auto mid = detail::lerp(0.5, interval.before, interval.past);
+    const auto mid_wssr = compute_wssr_bounded(fun, vec, mid, 0.5 * (interval.before_wssr + interval.past_wssr));
+    return detail::refine_minimum_in_interval(fun, vec, interval.before, interval.before_wssr, interval.past,
+                                              interval.past_wssr, mid, mid_wssr, max_iterations, 1);
+}
+
 /**
  * @brief Performs a binary search between lower and upper searching
  * the minimum.
@@ -90,52 +253,41 @@ Interval<NumberOfParameters> search_interval_around_minimum(const Function<Input
 template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
 parameter_t<NumberOfParameters> binary_search_minimum_in_interval(
     const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
-    parameter_t<NumberOfParameters> lower, parameter_t<NumberOfParameters> upper, std::size_t max_iterations) {
-    std::size_t iterations = 0;
-    minimize::floating_t lower_wssr = compute_wssr(fun, vec, lower);
-    minimize::floating_t upper_wssr = compute_wssr(fun, vec, upper);
-
-    do {
-        parameter_t<NumberOfParameters> mid = detail::lerp(0.5, lower, upper);
-        const minimize::floating_t mid_wssr = compute_wssr(fun, vec, mid);
-        if (mid_wssr == 0) {
-            return mid;
-        }
-
-        const minimize::floating_t half = 0.5;
-        const minimize::floating_t quarter = 0.25;
-        const minimize::floating_t parabola_opening = (lower_wssr + upper_wssr) * half - mid_wssr;
-        const minimize::floating_t parabola_vertex = quarter * ((lower_wssr - upper_wssr) / parabola_opening);
+    const parameter_t<NumberOfParameters>& lower, const parameter_t<NumberOfParameters>& upper,
+    std::size_t max_iterations) {
+    // the bounds and the middle share a pass over the data
+    std::array<parameter_t<NumberOfParameters>, 3> points{{lower, upper, detail::lerp(0.5, lower, upper)}};
+    std::array<minimize::floating_t, 3> wssr;
+    compute_wssr_multi(fun, vec, points.data(), points.size(), wssr.data());
+    return detail::refine_minimum_in_interval(fun, vec, lower, wssr[0], upper, wssr[1], points[2], wssr[2],
+                                              max_iterations, 1)
+        .parameters;
+}
 
-        if (parabola_opening > 0) {
-            if (parabola_vertex < 0) {
-                upper = mid;
-                upper_wssr = mid_wssr;
-            } else if (parabola_vertex > 0) {
-                lower = mid;
-                lower_wssr = mid_wssr;
-            } else {
-                // special case - only happens if lower_wssr==upper_wssr and mid_wssr<upper_wssr
-                // reduce interval on both sides by an asymmetric amount
-                const auto tmp = detail::lerp(0.01, lower, upper);
-                const auto tmp2 = detail::lerp(0.98, lower, upper);
-                lower = tmp;
-                upper = tmp2;
-                lower_wssr = compute_wssr(fun, vec, lower);
-                upper_wssr = compute_wssr(fun, vec, upper);
-            }
-        } else {
-            // special case - middle has worse wssr than outer positions
-            // we are done.
-            break;
-        }
-        ++iterations;
-    } while (iterations < max_iterations);
-    if (lower_wssr < upper_wssr) {
-        return lower;
-    } else {
-        return upper;
-    }
+/**
+ * @brief Finds a minimum of the wssr in the opposite direction of the gradient.
+ *
+ * The wssr at par is known by the solvers, passing it saves its computation. The wssr of the bracket found by
+ * search_interval_around_minimum() is reused by the binary search.
+ *
+ * @param[in] fun Function to minimize
+ * @param[in] par parameters for the function
+ * @param[in] start_wssr wssr at par
+ * @param[in] vec Measured data
+ * @param[in] gradient Gradient of wssr wrt to the function parameters
+ * @param[in] max_iterations Max number of iterations
+ * @return Found minimum with its wssr and the number of passes over the data
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+LineMinimum<NumberOfParameters> find_minimum_on_line(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                     const parameter_t<NumberOfParameters>& par,
+                                                     minimize::floating_t start_wssr, const DataVector& vec,
+                                                     const parameter_t<NumberOfParameters>& gradient,
+                                                     std::size_t max_iterations) {
+    const auto bracket = search_interval_around_minimum(fun, par, start_wssr, vec, gradient, max_iterations);
+    auto rv = binary_search_minimum_in_interval(fun, vec, bracket, max_iterations);
+    rv.evaluations += bracket.evaluations;
+    return rv;
 }
 
 /**
@@ -152,8 +304,7 @@ template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename
 typename Function<InputDimensions, NumberOfParameters>::parameter_t find_minimum_on_line(
     const Function<InputDimensions, NumberOfParameters>& fun, const parameter_t<NumberOfParameters>& par,
     const DataVector& vec, const parameter_t<NumberOfParameters>& gradient, std::size_t max_iterations) {
-    const auto bracket = search_interval_around_minimum(fun, par, vec, gradient, max_iterations);
-    return binary_search_minimum_in_interval(fun, vec, bracket.before, bracket.past, max_iterations);
+    return find_minimum_on_line(fun, par, compute_wssr(fun, vec, par), vec, gradient, max_iterations).parameters;
 }
 
 }  // namespace minimize
@@ -0,0 +1,114 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_FIT_MANY_INCLUDED_HPP
+#define MINIMIZE_FIT_MANY_INCLUDED_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "minimize/conjugate_gradient_descent.hpp"
+#include "minimize/fit_results.hpp"
+#include "minimize/lbfgs.hpp"
+#include "minimize/levenberg_marquardt.hpp"
+#include "minimize/solver_options.hpp"
+#include "minimize/steepest_descent.hpp"
+#include "minimize/stochastic_gradient_descent.hpp"
+#include "minimize/thread_pool.hpp"
+#include "minimize/variable_projection.hpp"
+
+namespace minimize {
+
+/** The solvers that can be selected for fit_many(). */
+enum class Solver {
+    steepest_descent,
+    conjugate_gradient_descent,
+    lbfgs,
+    levenberg_marquardt,
+    stochastic_gradient_descent,
+    variable_projection
+};
+
+namespace detail {
+
+/** Runs the selected solver. Throws std::invalid_argument if the value is not a Solver. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> run_solver(Solver solver,
+                                                    Function<InputDimensions, NumberOfParameters>& function,
+                                                    const DataVector& measurements, const SolverOptions& options) {
+    switch (solver) {
+        case Solver::steepest_descent:
+            return minimize::steepest_descent(function, measurements, options);
+        case Solver::conjugate_gradient_descent:
+            return minimize::conjugate_gradient_descent(function, measurements, options);
+        case Solver::lbfgs:
+            return minimize::lbfgs(function, measurements, options);
+        case Solver::stochastic_gradient_descent:
+            return minimize::stochastic_gradient_descent(function, measurements, options);
+        case Solver::variable_projection:
+            return minimize::variable_projection(function, measurements, options);
+        case Solver::levenberg_marquardt:
+            return minimize::levenberg_marquardt(function, measurements, options);
+    }
+    throw std::invalid_argument("Unknown solver!");
+}
+
+}  // namespace detail
+
+/**
+ * @brief Fits copies of a model to many independent data sets in parallel.
+ *
+ * The fits are distributed dynamically over the library thread pool (see set_thread_count()), so
+ * a thread that finishes early takes the next data set. Every worker fits its own copy of the model,
+ * each fit starts from the parameters of the prototype. The prototype is not modified.
+ * Work inside a fit, e.g. the bootstrap error estimation, runs serially in the worker.
+ *
+ * @param prototype the model with the initial parameters. Model must be copyable.
+ * @param datasets pointer to count data sets
+ * @param count number of data sets
+ * @param solver callable with the signature FitResults<P>(Model&, const DataVector&, const SolverOptions&)
+ * @param options settings passed to every fit
+ * @return the results in the order of the data sets
+ */
+template <typename Model, typename DataVector, typename SolverCallable>
+std::vector<FitResults<Model::number_of_parameters>> fit_many(const Model& prototype, const DataVector* datasets,
+                                                              std::size_t count, const SolverCallable& solver,
+                                                              const SolverOptions& options = SolverOptions{}) {
+    auto& pool = detail::global_thread_pool();
+    std::vector<Model> models(pool.size(), prototype);
+    std::vector<FitResults<Model::number_of_parameters>> results(count,
+                                                                 FitResults<Model::number_of_parameters>(0.0, 0));
+    pool.parallel_for(count, [&](std::size_t i, std::size_t worker) {
+        auto& model = models[worker];
+        model.set_parameters(prototype.parameters());
+        results[i] = solver(model, datasets[i], options);
+    });
+    return results;
+}
+
+/** Fits copies of a model to many independent data sets in parallel with the selected solver. */
+template <typename Model, typename DataVector>
+std::vector<FitResults<Model::number_of_parameters>> fit_many(const Model& prototype, const DataVector* datasets,
+                                                              std::size_t count, Solver solver,
+                                                              const SolverOptions& options = SolverOptions{}) {
+    return fit_many(
+        prototype, datasets, count,
+        [solver](Model& model, const DataVector& data, const SolverOptions& opts) {
+            return detail::run_solver(solver, model, data, opts);
+        },
+        options);
+}
+
+/** Fits copies of a model to every data set of the vector in parallel. */
+template <typename Model, typename DataVector, typename SolverType>
+std::vector<FitResults<Model::number_of_parameters>> fit_many(const Model& prototype,
+                                                              const std::vector<DataVector>& datasets,
+                                                              const SolverType& solver,
+                                                              const SolverOptions& options = SolverOptions{}) {
+    return fit_many(prototype, datasets.data(), datasets.size(), solver, options);
+}
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_FIT_MANY_INCLUDED_HPP */
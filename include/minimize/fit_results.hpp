@@ -12,6 +12,7 @@
 
 #include "minimize/detail/meta.hpp"
 #include "minimize/function.hpp"
+#include "minimize/instrumentation.hpp"
 
 namespace minimize {
 
@@ -46,12 +47,36 @@ public:
 
     void set_optimized_value_errors(const parameter_t& p) { optimized_parameter_errors_ = p; }
 
+    /** Covariance matrix of the optimized parameters. All elements are 0 if no errors were estimated. */
+    const matrix_t<NumberOfParameters>& covariance() const noexcept { return covariance_; }
+
+    /** Correlation matrix of the optimized parameters, computed from the covariance.
+     * The elements of parameters without variance are 0.
+     */
+    matrix_t<NumberOfParameters> correlation() const {
+        matrix_t<NumberOfParameters> rv;
+        for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+            for (std::size_t k = 0; k < NumberOfParameters; ++k) {
+                const auto variances = covariance_[i][i] * covariance_[k][k];
+                rv[i][k] = variances > 0.0 ? covariance_[i][k] / std::sqrt(variances) : 0.0;
+            }
+        }
+        return rv;
+    }
+
+    void set_covariance(const matrix_t<NumberOfParameters>& c) { covariance_ = c; }
+
     void set_weighted_sum_of_squared_residuals(const floating_t& p) { weighted_sum_of_squared_residuals_ = p; }
 
     void set_converged(bool v) noexcept { converged_ = v; }
 
     bool converged() const noexcept { return converged_; }
 
+    void set_cancelled(bool v) noexcept { cancelled_ = v; }
+
+    /** True if an observer stopped the fit or the bootstrap. */
+    bool cancelled() const noexcept { return cancelled_; }
+
     std::string create_report() const {
         std::stringstream stream;
         stream << "Fit Results\n";
@@ -69,6 +94,9 @@ public:
 
         stream << "Iterations   : " << iterations_ << "\n";
         stream << "Converged    : " << std::boolalpha << converged_ << "\n";
+        if (cancelled_) {
+            stream << "Cancelled    : true\n";
+        }
         stream << "WSSR         : " << weighted_sum_of_squared_residuals() << "\n";
         stream << "WSSR/NDF     : " << normalized_weighted_sum_of_squared_residuals() << "\n";
         stream << "\n";
@@ -88,6 +116,21 @@ public:
             stream << std::setprecision(default_precision);
         }
         stream << "\n\n";
+        if (has_covariance()) {
+            stream << "Correlation matrix:\n";
+            const auto rho = correlation();
+            stream << std::fixed << std::setprecision(3);
+            for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+                stream << std::setw(20) << parameter_names[i] << " |";
+                for (std::size_t k = 0; k <= i; ++k) {
+                    stream << " " << std::setw(6) << rho[i][k];
+                }
+                stream << "\n";
+            }
+            stream.unsetf(std::ios_base::floatfield);
+            stream << std::setprecision(default_precision) << "\n\n";
+        }
+        stream << statistics_.create_report();
 
         return stream.str();
     }
@@ -103,17 +146,36 @@ public:
 
     void set_iterations(std::size_t s) { iterations_ = s; }
 
+    std::size_t iterations() const noexcept { return iterations_; }
+
+    /** Counters, timings and wssr trajectory of the fit. Empty unless MINIMIZE_ENABLE_INSTRUMENTATION is 1. */
+    const FitStatistics& statistics() const noexcept { return statistics_; }
+
+    void set_statistics(const FitStatistics& s) { statistics_ = s; }
+
 private:
+    bool has_covariance() const noexcept {
+        for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+            if (covariance_[i][i] > 0.0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     parameter_t initial_values_{};
     floating_t initial_weighted_sum_of_squared_residuals_{};
     std::size_t number_of_data_points_{0};
     std::size_t iterations_{0};
     bool converged_{false};
+    bool cancelled_{false};
     floating_t weighted_sum_of_squared_residuals_{};
     std::array<std::string, NumberOfParameters> parameter_names{};
 
     parameter_t optimized_parameters_{};
     parameter_t optimized_parameter_errors_{};
+    matrix_t<NumberOfParameters> covariance_{};
+    FitStatistics statistics_{};
 };
 
 } /* namespace minimize */
@@ -12,6 +12,54 @@
 
 namespace minimize {
 
+namespace detail {
+
+/**
+ * @brief Numerically computes the gradient of fun wrt. to the parameters using a five point stencil.
+ *
+ * @param fun callable that evaluates the function for a set of parameters
+ * @param parameters the current parameters to use.
+ * @param epsilon the numerical differentiation epsilon
+ */
+template <typename Callable, std::size_t NumberOfParameters>
+parameter_t<NumberOfParameters> five_point_stencil(const Callable& fun,
+                                                   const parameter_t<NumberOfParameters>& parameters,
+                                                   floating_t epsilon) {
+    parameter_t<NumberOfParameters> gradient;
+    const floating_t dh = std::sqrt(std::sqrt(epsilon));
+    for (std::size_t i = 0; i < gradient.size(); ++i) {
+        parameter_t<NumberOfParameters> copy = parameters;
+        // 5 point stencil
+        const floating_t dp = parameters[i] != 0.0 ? parameters[i] * dh : dh;
+        volatile floating_t p_plus1 = parameters[i] + dp;
+        volatile floating_t p_plus2 = parameters[i] + 2.0 * dp;
+        volatile floating_t p_minus1 = parameters[i] - dp;
+        volatile floating_t p_minus2 = parameters[i] - 2.0 * dp;
+        const floating_t dx = 3.0 * (p_plus2 - p_minus2);
+
+        copy[i] = p_plus2;
+        const floating_t f_plus2 = fun(copy);
+        copy[i] = p_plus1;
+        const floating_t f_plus1 = fun(copy);
+        copy[i] = p_minus1;
+        const floating_t f_minus1 = fun(copy);
+        copy[i] = p_minus2;
+        const floating_t f_minus2 = fun(copy);
+
+        gradient[i] = (-f_plus2 + 8.0 * f_plus1 - 8.0 * f_minus1 + f_minus2) / dx;
+    }
+    return gradient;
+}
+
+}  // namespace detail
+
+/** Value of a function together with its gradient w.r.t. the parameters. */
+template <std::size_t NumberOfParameters>
+struct ValueAndGradient {
+    floating_t value{0.0};
+    parameter_t<NumberOfParameters> gradient{};
+};
+
 template <std::size_t InputDimensions, std::size_t NumberOfParameters>
 class Function {
 public:
@@ -33,6 +81,20 @@ public:
 
     virtual output_t evaluate(const input_t& x, const parameter_t& parameters) const = 0;
 
+    /**
+     * @brief Returns true if the function is linear in the i-th parameter. Used by variable_projection().
+     *
+     * The parameters marked as linear must enter the function linearly together, i.e. the function must have
+     * the form f(x, p) = h(x, q) + sum_i p_i * g_i(x, q), where p are the linear and q the other parameters.
+     * Examples are the amplitude and the offset of a peak. The default marks no parameter as linear.
+     *
+     * @param i index of the parameter
+     */
+    virtual bool is_linear_parameter(std::size_t i) const {
+        (void)i;
+        return false;
+    }
+
     output_t evaluate(const input_t& x) const { return evaluate(x, parameters_); }
 
     /**
@@ -45,34 +107,76 @@ public:
      * @return parameter_t the computed gradient
      */
     virtual parameter_t parameter_gradient(const input_t& x, const parameter_t& parameters) const {
-        parameter_t gradient;
-        const floating_t dh = std::sqrt(std::sqrt(numerical_differentiation_epsilon()));
-        for (std::size_t i = 0; i < gradient.size(); ++i) {
-            parameter_t copy = parameters;
-            // 5 point stencil
-            const floating_t dp = parameters[i] != 0.0 ? parameters[i] * dh : dh;
-            volatile floating_t p_plus1 = parameters[i] + dp;
-            volatile floating_t p_plus2 = parameters[i] + 2.0 * dp;
-            volatile floating_t p_minus1 = parameters[i] - dp;
-            volatile floating_t p_minus2 = parameters[i] - 2.0 * dp;
-            const floating_t dx = 3.0 * (p_plus2 - p_minus2);
-
-            copy[i] = p_plus2;
-            const floating_t f_plus2 = evaluate(x, copy);
-            copy[i] = p_plus1;
-            const floating_t f_plus1 = evaluate(x, copy);
-            copy[i] = p_minus1;
-            const floating_t f_minus1 = evaluate(x, copy);
-            copy[i] = p_minus2;
-            const floating_t f_minus2 = evaluate(x, copy);
-
-            gradient[i] = (-f_plus2 + 8.0 * f_plus1 - 8.0 * f_minus1 + f_minus2) / dx;
-        }
-        return gradient;
+        return detail::five_point_stencil(
+            [this, &x](const parameter_t& p) { return evaluate(x, p); }, parameters,
+            numerical_differentiation_epsilon());
     }
 
     parameter_t parameter_gradient(const input_t& x) const { return parameter_gradient(x, parameters_); }
 
+    /**
+     * @brief Computes the value and the gradient wrt. to the parameters in a single call.
+     *
+     * This is the method used by the solvers whenever both values are needed at the same point.
+     * The default implementation evaluates the function once and adds the result of parameter_gradient().
+     * The five point stencil has no weight at the centre, so the numerical default cannot save any
+     * evaluations. Override this method if the value and an analytic gradient share intermediate results.
+     *
+     * @param x the current position
+     * @param parameters the current parameters to use.
+     * @return ValueAndGradient<NumberOfParameters> the function value and the computed gradient
+     */
+    virtual ValueAndGradient<NumberOfParameters> evaluate_with_gradient(const input_t& x,
+                                                                        const parameter_t& parameters) const {
+        ValueAndGradient<NumberOfParameters> rv;
+        rv.value = evaluate(x, parameters);
+        rv.gradient = parameter_gradient(x, parameters);
+        return rv;
+    }
+
+    ValueAndGradient<NumberOfParameters> evaluate_with_gradient(const input_t& x) const {
+        return evaluate_with_gradient(x, parameters_);
+    }
+
+    /**
+     * @brief Evaluates the function at count positions with the same parameters.
+     *
+     * The library calls this method with blocks of data points, so there is only one virtual call
+     * per block. The default implementation calls evaluate() for every point. Override it to provide
+     * a vectorized implementation.
+     *
+     * @param x array with count positions
+     * @param count number of positions
+     * @param parameters the parameters to use.
+     * @param out array with space for count values
+     */
+    virtual void evaluate_batch(const input_t* x, std::size_t count, const parameter_t& parameters,
+                                output_t* out) const {
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = evaluate(x[i], parameters);
+        }
+    }
+
+    /**
+     * @brief Computes values and gradients at count positions with the same parameters.
+     *
+     * The default implementation calls evaluate_with_gradient() for every point.
+     *
+     * @param x array with count positions
+     * @param count number of positions
+     * @param parameters the parameters to use.
+     * @param values array with space for count values
+     * @param gradients array with space for count gradients
+     */
+    virtual void evaluate_with_gradient_batch(const input_t* x, std::size_t count, const parameter_t& parameters,
+                                              output_t* values, parameter_t* gradients) const {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto rv = evaluate_with_gradient(x[i], parameters);
+            values[i] = rv.value;
+            gradients[i] = rv.gradient;
+        }
+    }
+
     void set_parameters(const parameter_t& p) { parameters_ = p; }
 
     void set_parameter(std::size_t i, floating_t p) { parameters_[i] = p; }
@@ -90,7 +194,110 @@ private:
     floating_t epsilon_{1e-15};
 };
 
-/** Linear functions */
+/**
+ * @brief Base class for functions whose model is resolved at compile time.
+ *
+ * Derive as `class MyModel : public StaticFunction<MyModel, In, P>` and provide the non-virtual method
+ * `output_t model(const input_t& x, const parameter_t& parameters) const`. Optionally, provide
+ * `ValueAndGradient<P> model_with_gradient(const input_t& x, const parameter_t& parameters) const`
+ * with an analytic gradient; the default uses the five point stencil on model().
+ *
+ * All virtual methods of Function are implemented here and call the model directly. Since the solvers
+ * evaluate functions in batches, there is only one virtual call per batch and the model is inlined
+ * into the loop over the data points.
+ */
+template <typename Derived, std::size_t InputDimensions, std::size_t NumberOfParameters>
+class StaticFunction : public Function<InputDimensions, NumberOfParameters> {
+public:
+    using base_t = Function<InputDimensions, NumberOfParameters>;
+    using output_t = typename base_t::output_t;
+    using input_t = typename base_t::input_t;
+    using parameter_t = typename base_t::parameter_t;
+    using base_t::base_t;
+
+    output_t evaluate(const input_t& x, const parameter_t& parameters) const final {
+        return derived().model(x, parameters);
+    }
+    using base_t::evaluate;
+
+    parameter_t parameter_gradient(const input_t& x, const parameter_t& parameters) const final {
+        return derived().model_with_gradient(x, parameters).gradient;
+    }
+    using base_t::parameter_gradient;
+
+    ValueAndGradient<NumberOfParameters> evaluate_with_gradient(const input_t& x,
+                                                                const parameter_t& parameters) const final {
+        return derived().model_with_gradient(x, parameters);
+    }
+    using base_t::evaluate_with_gradient;
+
+    void evaluate_batch(const input_t* x, std::size_t count, const parameter_t& parameters,
+                        output_t* out) const final {
+        const Derived& self = derived();
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = self.model(x[i], parameters);
+        }
+    }
+
+    void evaluate_with_gradient_batch(const input_t* x, std::size_t count, const parameter_t& parameters,
+                                      output_t* values, parameter_t* gradients) const final {
+        const Derived& self = derived();
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto rv = self.model_with_gradient(x[i], parameters);
+            values[i] = rv.value;
+            gradients[i] = rv.gradient;
+        }
+    }
+
+    /** Default gradient: five point stencil on the model. Hide this method in Derived to provide an
+     * analytic gradient.
+     */
+    ValueAndGradient<NumberOfParameters> model_with_gradient(const input_t& x, const parameter_t& parameters) const {
+        const Derived& self = derived();
+        ValueAndGradient<NumberOfParameters> rv;
+        rv.value = self.model(x, parameters);
+        rv.gradient = detail::five_point_stencil([&self, &x](const parameter_t& p) { return self.model(x, p); },
+                                                 parameters, this->numerical_differentiation_epsilon());
+        return rv;
+    }
+
+private:
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+};
+
+namespace detail {
+
+/** Value of the polynomial sum p_i * x^i with the Horner scheme. */
+template <std::size_t NumberOfParameters>
+floating_t polynomial_value(floating_t x, const parameter_t<NumberOfParameters>& parameters) {
+    floating_t rv = parameters[NumberOfParameters - 1];
+    for (std::size_t i = NumberOfParameters - 1; i > 0; --i) {
+        rv = rv * x + parameters[i - 1];
+    }
+    return rv;
+}
+
+/** Value and exact gradient of the polynomial sum p_i * x^i. The gradient is the power series 1, x, x^2, ... */
+template <std::size_t NumberOfParameters>
+ValueAndGradient<NumberOfParameters> polynomial_value_and_gradient(floating_t x,
+                                                                   const parameter_t<NumberOfParameters>& parameters) {
+    ValueAndGradient<NumberOfParameters> rv;
+    rv.value = parameters[NumberOfParameters - 1];
+    rv.gradient[0] = 1.0;
+    for (std::size_t i = 1; i < NumberOfParameters; ++i) {
+        rv.value = rv.value * x + parameters[NumberOfParameters - 1 - i];
+        rv.gradient[i] = rv.gradient[i - 1] * x;
+    }
+    return rv;
+}
+
+}  // namespace detail
+
+/** Polynomials of the given degree. The i-th parameter is the coefficient of x^i.
+ * Values are computed with the Horner scheme, the gradient w.r.t. the parameters is exact.
+ * Polynomials are linear in their parameters, so they can be fitted with linear_least_squares().
+ * All methods are virtual and can be overridden, see StaticPolynomial for a version with inlined batches.
+ */
 template <std::size_t Degree>
 class Polynomial : public minimize::Function<1, Degree + 1> {
 public:
@@ -101,16 +308,48 @@ public:
     using parameter_t = typename base_t::parameter_t;
 
     virtual floating_t evaluate(const input_t& x, const parameter_t& parameters) const {
-        minimize::floating_t t = 1.0;
-        minimize::floating_t rv = parameters[0];
-        for (size_t i = 1; i <= Degree; ++i) {
-            t *= x;
-            rv += t * parameters[i];
-        }
-        return rv;
+        return detail::polynomial_value(x, parameters);
     }
-
     using base_t::evaluate;
+
+    /** The gradient is the power series 1, x, x^2, ... */
+    virtual parameter_t parameter_gradient(const input_t& x, const parameter_t& parameters) const {
+        return detail::polynomial_value_and_gradient(x, parameters).gradient;
+    }
+    using base_t::parameter_gradient;
+
+    virtual ValueAndGradient<Degree + 1> evaluate_with_gradient(const input_t& x,
+                                                                const parameter_t& parameters) const {
+        return detail::polynomial_value_and_gradient(x, parameters);
+    }
+    using base_t::evaluate_with_gradient;
+
+    /** All coefficients enter the polynomial linearly. */
+    virtual bool is_linear_parameter(std::size_t) const { return true; }
+};
+
+/** Polynomial of the given degree as StaticFunction: the batches of the solvers inline the Horner scheme.
+ * The evaluation methods are final, derive from Polynomial to override them.
+ */
+template <std::size_t Degree>
+class StaticPolynomial : public minimize::StaticFunction<StaticPolynomial<Degree>, 1, Degree + 1> {
+public:
+    using base_t = typename minimize::StaticFunction<StaticPolynomial<Degree>, 1, Degree + 1>;
+    using base_t::base_t;
+    using output_t = typename base_t::output_t;
+    using input_t = typename base_t::input_t;
+    using parameter_t = typename base_t::parameter_t;
+
+    floating_t model(const input_t& x, const parameter_t& parameters) const {
+        return detail::polynomial_value(x, parameters);
+    }
+
+    ValueAndGradient<Degree + 1> model_with_gradient(const input_t& x, const parameter_t& parameters) const {
+        return detail::polynomial_value_and_gradient(x, parameters);
+    }
+
+    /** All coefficients enter the polynomial linearly. */
+    virtual bool is_linear_parameter(std::size_t) const { return true; }
 };
 
 }  // namespace minimize
@@ -0,0 +1,239 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_INSTRUMENTATION_INCLUDED_HPP
+#define MINIMIZE_INSTRUMENTATION_INCLUDED_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "minimize/detail/meta.hpp"
+
+/** Define as 1 to record the statistics of every fit. Defaults to 0, then all recording compiles to nothing.
+ * The value must be the same in all translation units of a program.
+ */
+#ifndef MINIMIZE_ENABLE_INSTRUMENTATION
+#define MINIMIZE_ENABLE_INSTRUMENTATION 0
+#endif
+
+namespace minimize {
+
+/** True if the library records fit statistics. */
+constexpr bool instrumentation_enabled = MINIMIZE_ENABLE_INSTRUMENTATION != 0;
+
+#if MINIMIZE_ENABLE_INSTRUMENTATION
+
+/**
+ * @brief Counters, timings and the wssr trajectory of a fit.
+ *
+ * Only recorded if MINIMIZE_ENABLE_INSTRUMENTATION is 1. The counters include all work done by the solver
+ * on the thread of the fit, including the passes of parallel reductions.
+ */
+class FitStatistics {
+public:
+    /** Number of points evaluated without the gradient. */
+    std::size_t evaluations() const noexcept { return evaluations_; }
+
+    /** Number of points evaluated together with the parameter gradient. */
+    std::size_t gradient_evaluations() const noexcept { return gradient_evaluations_; }
+
+    /** Number of passes over all measurements. */
+    std::size_t data_passes() const noexcept { return data_passes_; }
+
+    /** Passes over the data of every line search, in the order of the searches. */
+    const std::vector<std::size_t>& line_search_passes() const noexcept { return line_search_passes_; }
+
+    /** The wssr before the fit and after every accepted iteration. */
+    const std::vector<floating_t>& wssr_trajectory() const noexcept { return wssr_trajectory_; }
+
+    /** Wall clock time of the fit without the bootstrap. */
+    double fit_seconds() const noexcept { return fit_seconds_; }
+
+    /** Wall clock time of every bootstrap resample, in the order of the resamples. */
+    const std::vector<double>& resample_seconds() const noexcept { return resample_seconds_; }
+
+    void add_evaluations(std::size_t n) noexcept { evaluations_ += n; }
+
+    void add_gradient_evaluations(std::size_t n) noexcept { gradient_evaluations_ += n; }
+
+    void add_data_pass() noexcept { ++data_passes_; }
+
+    void add_line_search(std::size_t passes) { line_search_passes_.push_back(passes); }
+
+    void add_wssr(floating_t wssr) { wssr_trajectory_.push_back(wssr); }
+
+    void set_fit_seconds(double s) noexcept { fit_seconds_ = s; }
+
+    void set_resample_seconds(std::vector<double> s) { resample_seconds_ = std::move(s); }
+
+    std::string create_report() const {
+        std::stringstream stream;
+        stream << "Statistics:\n";
+        stream << "Evaluations           : " << evaluations_ << "\n";
+        stream << "Gradient evaluations  : " << gradient_evaluations_ << "\n";
+        stream << "Data passes           : " << data_passes_ << "\n";
+        std::size_t line_search_total = 0;
+        for (const auto passes : line_search_passes_) {
+            line_search_total += passes;
+        }
+        stream << "Line searches         : " << line_search_passes_.size() << " (" << line_search_total
+               << " data passes)\n";
+        stream << "Fit time              : " << fit_seconds_ << " s\n";
+        if (!resample_seconds_.empty()) {
+            double total = 0.0;
+            for (const auto s : resample_seconds_) {
+                total += s;
+            }
+            stream << "Bootstrap resamples   : " << resample_seconds_.size() << " (" << total << " s)\n";
+        }
+        stream << "WSSR trajectory       :";
+        for (const auto w : wssr_trajectory_) {
+            stream << " " << w;
+        }
+        stream << "\n\n";
+        return stream.str();
+    }
+
+private:
+    std::size_t evaluations_{0};
+    std::size_t gradient_evaluations_{0};
+    std::size_t data_passes_{0};
+    std::vector<std::size_t> line_search_passes_{};
+    std::vector<floating_t> wssr_trajectory_{};
+    double fit_seconds_{0.0};
+    std::vector<double> resample_seconds_{};
+};
+
+#else
+
+/** Fit statistics without instrumentation. All values are 0 or empty and nothing is stored. */
+class FitStatistics {
+public:
+    std::size_t evaluations() const noexcept { return 0; }
+    std::size_t gradient_evaluations() const noexcept { return 0; }
+    std::size_t data_passes() const noexcept { return 0; }
+    const std::vector<std::size_t>& line_search_passes() const noexcept { return empty<std::size_t>(); }
+    const std::vector<floating_t>& wssr_trajectory() const noexcept { return empty<floating_t>(); }
+    double fit_seconds() const noexcept { return 0.0; }
+    const std::vector<double>& resample_seconds() const noexcept { return empty<double>(); }
+
+    void add_evaluations(std::size_t) noexcept {}
+    void add_gradient_evaluations(std::size_t) noexcept {}
+    void add_data_pass() noexcept {}
+    void add_line_search(std::size_t) noexcept {}
+    void add_wssr(floating_t) noexcept {}
+    void set_fit_seconds(double) noexcept {}
+    void set_resample_seconds(const std::vector<double>&) noexcept {}
+
+    std::string create_report() const { return std::string(); }
+
+private:
+    template <typename T>
+    static const std::vector<T>& empty() noexcept {
+        static const std::vector<T> rv{};
+        return rv;
+    }
+};
+
+#endif
+
+namespace detail {
+
+#if MINIMIZE_ENABLE_INSTRUMENTATION
+
+/** Statistics of the fit running on this thread, nullptr outside of fits. */
+inline FitStatistics*& current_statistics() noexcept {
+    static thread_local FitStatistics* rv = nullptr;
+    return rv;
+}
+
+inline void record_evaluations(std::size_t n) noexcept {
+    if (auto* s = current_statistics()) {
+        s->add_evaluations(n);
+    }
+}
+
+inline void record_gradient_evaluations(std::size_t n) noexcept {
+    if (auto* s = current_statistics()) {
+        s->add_gradient_evaluations(n);
+    }
+}
+
+inline void record_data_pass() noexcept {
+    if (auto* s = current_statistics()) {
+        s->add_data_pass();
+    }
+}
+
+inline std::size_t recorded_data_passes() noexcept {
+    const auto* s = current_statistics();
+    return s != nullptr ? s->data_passes() : 0;
+}
+
+inline void record_line_search(std::size_t passes) {
+    if (auto* s = current_statistics()) {
+        s->add_line_search(passes);
+    }
+}
+
+inline void record_wssr(floating_t wssr) {
+    if (auto* s = current_statistics()) {
+        s->add_wssr(wssr);
+    }
+}
+
+/**
+ * @brief Collects the statistics of a fit.
+ *
+ * Create one at the start of a solver. While it exists, the statistics of the current thread are recorded
+ * into it. finish() stores the statistics with the elapsed time in the results.
+ */
+class FitRecorder {
+public:
+    FitRecorder() : previous_(current_statistics()), start_(std::chrono::steady_clock::now()) {
+        current_statistics() = &statistics_;
+    }
+
+    FitRecorder(const FitRecorder&) = delete;
+    FitRecorder& operator=(const FitRecorder&) = delete;
+
+    ~FitRecorder() { current_statistics() = previous_; }
+
+    template <typename Results>
+    void finish(Results& results) {
+        statistics_.set_fit_seconds(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count());
+        results.set_statistics(statistics_);
+    }
+
+private:
+    FitStatistics statistics_{};
+    FitStatistics* previous_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#else
+
+inline void record_evaluations(std::size_t) noexcept {}
+inline void record_gradient_evaluations(std::size_t) noexcept {}
+inline void record_data_pass() noexcept {}
+inline std::size_t recorded_data_passes() noexcept { return 0; }
+inline void record_line_search(std::size_t) noexcept {}
+inline void record_wssr(floating_t) noexcept {}
+
+class FitRecorder {
+public:
+    template <typename Results>
+    void finish(Results&) noexcept {}
+};
+
+#endif
+
+}  // namespace detail
+}  // namespace minimize
+
+#endif /* MINIMIZE_INSTRUMENTATION_INCLUDED_HPP */
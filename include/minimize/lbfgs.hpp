@@ -0,0 +1,194 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_LBFGS_INCLUDED_HPP
+#define MINIMIZE_LBFGS_INCLUDED_HPP
+
+#include <array>
+#include <cstddef>
+#include <limits>
+
+#include "minimize/bootstrap.hpp"
+#include "minimize/detail/vector_math.hpp"
+#include "minimize/fit_results.hpp"
+#include "minimize/function.hpp"
+#include "minimize/line_search.hpp"
+#include "minimize/measurement.hpp"
+#include "minimize/observer.hpp"
+#include "minimize/solver_options.hpp"
+#include "minimize/wssr.hpp"
+
+namespace minimize {
+
+namespace detail {
+
+/**
+ * @brief Ring buffer with the last History parameter changes s and gradient changes y of L-BFGS.
+ *
+ * All storage has a fixed size, adding a pair overwrites the oldest one once the buffer is full.
+ */
+template <std::size_t NumberOfParameters, std::size_t History>
+class LbfgsHistory {
+public:
+    static_assert(History > 0, "The history must store at least one pair!");
+    using parameter_t = minimize::parameter_t<NumberOfParameters>;
+
+    std::size_t size() const noexcept { return size_; }
+
+    bool empty() const noexcept { return size_ == 0; }
+
+    void clear() noexcept { size_ = 0; }
+
+    /** Stores the pair if the curvature s*y is positive. Returns false if the pair was rejected. */
+    bool push(const parameter_t& s, const parameter_t& y) {
+        const auto sy = detail::dot(s, y);
+        const auto yy = detail::dot(y, y);
+        if (!(sy > std::numeric_limits<minimize::floating_t>::epsilon() * yy)) {
+            return false;
+        }
+        newest_ = (newest_ + 1) % History;
+        s_[newest_] = s;
+        y_[newest_] = y;
+        rho_[newest_] = 1.0 / sy;
+        gamma_ = sy / yy;
+        if (size_ < History) {
+            ++size_;
+        }
+        return true;
+    }
+
+    /** Computes H * gradient with the two loop recursion, where H approximates the inverse hessian. */
+    parameter_t apply(const parameter_t& gradient) const {
+        std::array<minimize::floating_t, History> alpha;
+        parameter_t q = gradient;
+        for (std::size_t k = 0; k < size_; ++k) {
+            const std::size_t i = index(k);
+            alpha[i] = rho_[i] * detail::dot(s_[i], q);
+            detail::add_to_vector(q, -alpha[i], y_[i]);
+        }
+        parameter_t r = detail::scale_vector(gamma_, q);
+        for (std::size_t k = size_; k > 0; --k) {
+            const std::size_t i = index(k - 1);
+            const auto beta = rho_[i] * detail::dot(y_[i], r);
+            detail::add_to_vector(r, alpha[i] - beta, s_[i]);
+        }
+        return r;
+    }
+
+private:
+    /** Index of the k-th newest pair. */
+    std::size_t index(std::size_t k) const noexcept { return (newest_ + History - k) % History; }
+
+    std::array<parameter_t, History> s_{};
+    std::array<parameter_t, History> y_{};
+    std::array<minimize::floating_t, History> rho_{};
+    minimize::floating_t gamma_{1.0};
+    std::size_t newest_{History - 1};
+    std::size_t size_{0};
+};
+
+template <std::size_t History, std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> lbfgs_impl(const Function<InputDimensions, NumberOfParameters>& function,
+                                                    const DataVector& measurements, const SolverOptions& options) {
+    FitRecorder recorder;
+    auto minimum = function.parameters();
+    std::size_t iterations = 0;
+
+    auto current = compute_wssr_and_gradient(function, measurements, minimum);
+    auto wssr = current.wssr;
+
+    minimize::FitResults<NumberOfParameters> results(wssr, measurements.size());
+    results.initialize_before_fit(function);
+    record_wssr(wssr);
+    LbfgsHistory<NumberOfParameters, History> history;
+    LineSearchState state;
+    const auto method =
+        options.line_search == LineSearch::automatic ? LineSearch::strong_wolfe : options.line_search;
+    auto rel_change = 10.0 * options.tolerance;
+    bool cancelled = false;
+    do {
+        if (wssr == 0.0) {
+            break;
+        }
+        auto direction = history.empty() ? current.gradient : history.apply(current.gradient);
+        if (!(detail::dot(direction, current.gradient) > 0.0)) {
+            history.clear();
+            direction = current.gradient;
+        }
+        if (!history.empty()) {
+            // the full quasi-Newton step is the natural first trial
+            state.step = 1.0;
+            state.slope = -detail::dot(direction, current.gradient);
+        }
+        const auto next = line_search(function, measurements, minimum, current, direction, method, state);
+        if (next.value.wssr >= wssr) {
+            if (history.empty()) {
+                break;
+            }
+            // retry along the gradient
+            history.clear();
+            continue;
+        }
+        history.push(detail::axpy(-1.0, minimum, next.parameters), detail::axpy(-1.0, current.gradient,
+                                                                                 next.value.gradient));
+        minimum = next.parameters;
+        current = next.value;
+        rel_change = 1.0 - current.wssr / wssr;
+        wssr = current.wssr;
+        record_wssr(wssr);
+        ++iterations;
+        if (observer_stops_fit(options.observer, iterations, minimum, wssr, rel_change)) {
+            cancelled = true;
+            break;
+        }
+    } while (iterations < options.max_iterations && options.tolerance < rel_change);
+
+    results.set_converged(iterations < options.max_iterations && !cancelled);
+    results.set_cancelled(cancelled);
+    results.set_iterations(iterations);
+    results.set_weighted_sum_of_squared_residuals(wssr);
+    results.set_optimized_values(minimum);
+    recorder.finish(results);
+    return results;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Fits the function parameters with the limited memory BFGS algorithm.
+ *
+ * The solver approximates the inverse hessian from the last History pairs of parameter and gradient changes.
+ * The pairs are kept in fixed size arrays, so the iterations do not allocate memory. Each iteration performs one
+ * line search along the quasi-Newton direction. LineSearch::automatic selects the strong Wolfe search: its steps
+ * guarantee positive curvature pairs and the full step is usually accepted after a single data pass.
+ *
+ * @tparam History number of stored pairs
+ * @param function Function to fit. The optimized parameters are stored in the function.
+ * @param measurements Measured data
+ * @param options settings of the fit
+ * @return FitResults<NumberOfParameters>
+ */
+template <std::size_t History = 8, std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> lbfgs(Function<InputDimensions, NumberOfParameters>& function,
+                                               const DataVector& measurements, const SolverOptions& options) {
+    return minimize::bootstrap_errors<InputDimensions, NumberOfParameters, DataVector>(
+        function, measurements,
+        [&options](const Function<InputDimensions, NumberOfParameters>& f, const DataVector& data,
+                   minimize::floating_t, std::size_t) { return detail::lbfgs_impl<History>(f, data, options); },
+        options.bootstrap, options.tolerance, options.max_iterations);
+}
+
+/** Fits the function parameters with L-BFGS and the strong Wolfe line search. */
+template <std::size_t History = 8, std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> lbfgs(Function<InputDimensions, NumberOfParameters>& function,
+                                               const DataVector& measurements, minimize::floating_t tolerance = 1e-15,
+                                               std::size_t max_iterations = 16535) {
+    SolverOptions options;
+    options.tolerance = tolerance;
+    options.max_iterations = max_iterations;
+    return lbfgs<History>(function, measurements, options);
+}
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_LBFGS_INCLUDED_HPP */
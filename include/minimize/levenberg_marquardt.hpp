@@ -0,0 +1,170 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_LEVENBERG_MARQUARDT_INCLUDED_HPP
+#define MINIMIZE_LEVENBERG_MARQUARDT_INCLUDED_HPP
+
+#include <algorithm>
+
+#include "minimize/bootstrap.hpp"
+#include "minimize/detail/linear_algebra.hpp"
+#include "minimize/detail/normal_equations.hpp"
+#include "minimize/fit_results.hpp"
+#include "minimize/function.hpp"
+#include "minimize/measurement.hpp"
+#include "minimize/observer.hpp"
+#include "minimize/solver_options.hpp"
+#include "minimize/wssr.hpp"
+
+namespace minimize {
+
+namespace detail {
+
+/**
+ * @brief Computes the next parameters by solving the damped normal equations
+ * (J^T W J + lambda * diag(J^T W J)) * delta = J^T W r.
+ *
+ * @param[in] system normal equations at the current parameters
+ * @param[in] par current parameters
+ * @param[in] lambda damping factor
+ * @param[out] next the parameters after the step
+ * @return false if the damped system could not be solved
+ */
+template <std::size_t NumberOfParameters>
+bool levenberg_marquardt_step(const NormalEquations<NumberOfParameters>& system,
+                              const minimize::parameter_t<NumberOfParameters>& par, minimize::floating_t lambda,
+                              minimize::parameter_t<NumberOfParameters>& next) {
+    auto damped = system.jtj;
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        // parameters without any influence on the data still need damping to keep the matrix regular
+        const auto diagonal = system.jtj[i][i] > 0.0 ? system.jtj[i][i] : 1.0;
+        damped[i][i] += lambda * diagonal;
+    }
+    if (!cholesky_decomposition(damped)) {
+        return false;
+    }
+    const auto delta = cholesky_solve(damped, system.jtr);
+    next = detail::axpy(-1.0, delta, par);
+    return true;
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> levenberg_marquardt_impl(
+    const Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
+    const SolverOptions& options) {
+    FitRecorder recorder;
+    const auto tolerance = options.tolerance;
+    const auto max_iterations = options.max_iterations;
+    const minimize::floating_t lambda_scale = 10.0;
+    const minimize::floating_t min_lambda = 1e-12;
+    const minimize::floating_t max_lambda = 1e16;
+
+    auto minimum = function.parameters();
+    std::size_t iterations = 0;
+
+    auto system = compute_normal_equations(function, measurements, minimum);
+    auto wssr = system.wssr;
+
+    minimize::FitResults<NumberOfParameters> results(wssr, measurements.size());
+    results.initialize_before_fit(function);
+    record_wssr(wssr);
+    minimize::floating_t lambda = 1e-3;
+    auto rel_change = 10.0 * tolerance;
+    bool cancelled = false;
+    do {
+        if (wssr == 0.0) {
+            break;
+        }
+        minimize::parameter_t<NumberOfParameters> next_parameters;
+        const bool solved = levenberg_marquardt_step(system, minimum, lambda, next_parameters);
+        const auto next_wssr = solved ? compute_wssr(function, measurements, next_parameters) : wssr;
+        if (next_wssr < wssr) {
+            rel_change = 1.0 - next_wssr / wssr;
+            minimum = next_parameters;
+            wssr = next_wssr;
+            record_wssr(wssr);
+            lambda = std::max(lambda / lambda_scale, min_lambda);
+            if (tolerance < rel_change) {
+                system = compute_normal_equations(function, measurements, minimum);
+            }
+        } else {
+            // rejected step: move towards steepest descent with a shorter step
+            lambda *= lambda_scale;
+            if (lambda > max_lambda) {
+                break;
+            }
+        }
+        ++iterations;
+        if (observer_stops_fit(options.observer, iterations, minimum, wssr, rel_change)) {
+            cancelled = true;
+            break;
+        }
+    } while (iterations < max_iterations && tolerance < rel_change);
+
+    results.set_converged(iterations < max_iterations && !cancelled);
+    results.set_cancelled(cancelled);
+    results.set_iterations(iterations);
+    results.set_weighted_sum_of_squared_residuals(wssr);
+    results.set_optimized_values(minimum);
+    recorder.finish(results);
+    return results;
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> levenberg_marquardt_impl(
+    const Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
+    minimize::floating_t tolerance = 1e-15, std::size_t max_iterations = 16535) {
+    SolverOptions options;
+    options.tolerance = tolerance;
+    options.max_iterations = max_iterations;
+    return levenberg_marquardt_impl(function, measurements, options);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Fits the function parameters with the Levenberg-Marquardt algorithm.
+ *
+ * Each iteration assembles J^T W J and J^T W r in one pass over the data and solves
+ * the small damped system of normal equations. Least squares problems typically converge
+ * in far fewer data passes than with the gradient descent methods.
+ * The line search setting of the options is not used.
+ *
+ * @param function Function to fit. The optimized parameters are stored in the function.
+ * @param measurements Measured data
+ * @param options settings of the fit
+ * @return FitResults<NumberOfParameters>
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> levenberg_marquardt(Function<InputDimensions, NumberOfParameters>& function,
+                                                             const DataVector& measurements,
+                                                             const SolverOptions& options) {
+    return minimize::bootstrap_errors<InputDimensions, NumberOfParameters, DataVector>(
+        function, measurements,
+        [&options](const Function<InputDimensions, NumberOfParameters>& f, const DataVector& data,
+                   minimize::floating_t, std::size_t) { return detail::levenberg_marquardt_impl(f, data, options); },
+        options.bootstrap, options.tolerance, options.max_iterations);
+}
+
+/** Fits the function parameters with the Levenberg-Marquardt algorithm.
+ *
+ * @param function Function to fit. The optimized parameters are stored in the function.
+ * @param measurements Measured data
+ * @param tolerance the fit stops if the relative change of the wssr is below this value
+ * @param max_iterations iteration limit
+ * @return FitResults<NumberOfParameters>
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> levenberg_marquardt(Function<InputDimensions, NumberOfParameters>& function,
+                                                             const DataVector& measurements,
+                                                             minimize::floating_t tolerance = 1e-15,
+                                                             std::size_t max_iterations = 16535) {
+    SolverOptions options;
+    options.tolerance = tolerance;
+    options.max_iterations = max_iterations;
+    return levenberg_marquardt(function, measurements, options);
+}
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_LEVENBERG_MARQUARDT_INCLUDED_HPP */
@@ -0,0 +1,247 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_LINE_SEARCH_INCLUDED_HPP
+#define MINIMIZE_LINE_SEARCH_INCLUDED_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "minimize/detail/vector_math.hpp"
+#include "minimize/find_minimum_on_line.hpp"
+#include "minimize/function.hpp"
+#include "minimize/solver_options.hpp"
+#include "minimize/wssr.hpp"
+
+namespace minimize {
+
+/** Result of a line search: the accepted point with its wssr and gradient. */
+template <std::size_t NumberOfParameters>
+struct LineSearchResult {
+    parameter_t<NumberOfParameters> parameters{};
+    WssrAndGradient<NumberOfParameters> value{};
+    /** Accepted step length along the search direction. */
+    minimize::floating_t step{0.0};
+    /** Number of passes over the data. */
+    std::size_t evaluations{0};
+    /** True if the conditions of the line search hold at the accepted point. */
+    bool converged{false};
+};
+
+/** State kept between the line searches of one fit. */
+struct LineSearchState {
+    /** Step accepted by the previous search, 0 if there was none. */
+    minimize::floating_t step{0.0};
+    /** Directional derivative at the start of the previous search. */
+    minimize::floating_t slope{0.0};
+};
+
+namespace detail {
+
+/** A point on the search line. */
+template <std::size_t NumberOfParameters>
+struct LinePoint {
+    minimize::floating_t step{0.0};
+    minimize::floating_t slope{0.0};
+    parameter_t<NumberOfParameters> parameters{};
+    WssrAndGradient<NumberOfParameters> value{};
+};
+
+/** Minimizer of the cubic through both points with the given slopes, restricted to the inner 80% of the
+ * interval. Falls back to bisection if the cubic has no minimum.
+ */
+template <std::size_t NumberOfParameters>
+minimize::floating_t interpolate_step(const LinePoint<NumberOfParameters>& lo,
+                                      const LinePoint<NumberOfParameters>& hi) {
+    const auto width = hi.step - lo.step;
+    const auto d1 = lo.slope + hi.slope - 3.0 * (lo.value.wssr - hi.value.wssr) / (lo.step - hi.step);
+    const auto radicand = d1 * d1 - lo.slope * hi.slope;
+    auto step = lo.step + 0.5 * width;
+    if (radicand >= 0.0) {
+        const auto d2 = std::copysign(std::sqrt(radicand), width);
+        const auto cubic = hi.step - width * (hi.slope + d2 - d1) / (hi.slope - lo.slope + 2.0 * d2);
+        if (std::isfinite(cubic)) {
+            step = cubic;
+        }
+    }
+    const auto a = lo.step + 0.1 * width;
+    const auto b = hi.step - 0.1 * width;
+    return std::min(std::max(step, std::min(a, b)), std::max(a, b));
+}
+
+}  // namespace detail
+
+/**
+ * @brief Searches a step along the direction -direction that satisfies the strong Wolfe conditions.
+ *
+ * Every trial point costs one fused pass over the data that yields the wssr and the gradient, so the
+ * directional derivative is available without extra work. The search stops as soon as
+ * wssr(step) <= wssr(0) + c1 * step * slope(0) and |slope(step)| <= c2 * |slope(0)| hold.
+ * The first trial step is derived from the previous accepted step stored in state, the state is updated
+ * with the accepted step. If the conditions cannot be met within max_evaluations, the point with the smallest
+ * wssr is returned.
+ *
+ * @param fun Function to minimize
+ * @param vec Measured data
+ * @param par parameters at the start of the search
+ * @param start wssr and gradient at par
+ * @param direction the search moves along -direction, e.g. the gradient
+ * @param state warm start information shared between the searches of a fit
+ * @param max_evaluations limit for the passes over the data
+ * @param c1 constant of the sufficient decrease condition
+ * @param c2 constant of the curvature condition
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+LineSearchResult<NumberOfParameters> strong_wolfe_line_search(
+    const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+    const parameter_t<NumberOfParameters>& par, const WssrAndGradient<NumberOfParameters>& start,
+    const parameter_t<NumberOfParameters>& direction, LineSearchState& state, std::size_t max_evaluations = 20,
+    minimize::floating_t c1 = 1e-4, minimize::floating_t c2 = 0.1) {
+    using point_t = detail::LinePoint<NumberOfParameters>;
+    LineSearchResult<NumberOfParameters> rv;
+    rv.parameters = par;
+    rv.value = start;
+
+    point_t origin;
+    origin.parameters = par;
+    origin.value = start;
+    origin.slope = -detail::dot(start.gradient, direction);
+    if (!(origin.slope < 0.0)) {
+        return rv;
+    }
+
+    std::size_t evaluations = 0;
+    auto evaluate = [&](minimize::floating_t step) {
+        point_t p;
+        p.step = step;
+        p.parameters = detail::axpy(-step, direction, par);
+        p.value = compute_wssr_and_gradient(fun, vec, p.parameters);
+        p.slope = -detail::dot(p.value.gradient, direction);
+        ++evaluations;
+        return p;
+    };
+    auto sufficient_decrease = [&](const point_t& p) {
+        return p.value.wssr <= origin.value.wssr + c1 * p.step * origin.slope;
+    };
+    auto curvature = [&](const point_t& p) { return std::abs(p.slope) <= -c2 * origin.slope; };
+
+    // warm start: assume the decrease along the line is similar to the previous iteration
+    minimize::floating_t step = state.step > 0.0 && state.slope < 0.0 ? state.step * state.slope / origin.slope
+                                                                      : -origin.value.wssr / origin.slope;
+    if (!(step > 0.0) || !std::isfinite(step)) {
+        step = 1.0;
+    }
+
+    point_t best = origin;
+    point_t accepted;
+    bool converged = false;
+    point_t previous = origin;
+    point_t lo;
+    point_t hi;
+    bool zoom = false;
+    while (evaluations < max_evaluations) {
+        const auto current = evaluate(step);
+        if (current.value.wssr < best.value.wssr) {
+            best = current;
+        }
+        if (!sufficient_decrease(current) || (evaluations > 1 && current.value.wssr >= previous.value.wssr)) {
+            lo = previous;
+            hi = current;
+            zoom = true;
+            break;
+        }
+        if (curvature(current)) {
+            accepted = current;
+            converged = true;
+            break;
+        }
+        if (current.slope >= 0.0) {
+            lo = current;
+            hi = previous;
+            zoom = true;
+            break;
+        }
+        previous = current;
+        step *= 2.0;
+    }
+
+    while (zoom && evaluations < max_evaluations) {
+        const auto current = evaluate(detail::interpolate_step(lo, hi));
+        if (current.value.wssr < best.value.wssr) {
+            best = current;
+        }
+        if (!sufficient_decrease(current) || current.value.wssr >= lo.value.wssr) {
+            hi = current;
+        } else {
+            if (curvature(current)) {
+                accepted = current;
+                converged = true;
+                break;
+            }
+            if (current.slope * (hi.step - lo.step) >= 0.0) {
+                hi = lo;
+            }
+            lo = current;
+        }
+        if (std::abs(hi.step - lo.step) <= 1e-12 * std::abs(lo.step)) {
+            break;
+        }
+    }
+
+    if (!converged) {
+        accepted = best;
+    }
+    rv.parameters = accepted.parameters;
+    rv.value = accepted.value;
+    rv.step = accepted.step;
+    rv.evaluations = evaluations;
+    rv.converged = converged;
+    if (accepted.step > 0.0) {
+        state.step = accepted.step;
+        state.slope = origin.slope;
+    }
+    return rv;
+}
+
+namespace detail {
+
+/**
+ * @brief Runs the selected line search from par along -direction. start holds the wssr and gradient at par.
+ * LineSearch::automatic runs the bracketing search.
+ *
+ * The gradient at the accepted point is only computed if its wssr is smaller than start.wssr. Otherwise par and
+ * start are returned.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+LineSearchResult<NumberOfParameters> line_search(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                 const DataVector& vec, const parameter_t<NumberOfParameters>& par,
+                                                 const WssrAndGradient<NumberOfParameters>& start,
+                                                 const parameter_t<NumberOfParameters>& direction,
+                                                 LineSearch method, LineSearchState& state) {
+    const auto passes = recorded_data_passes();
+    LineSearchResult<NumberOfParameters> rv;
+    if (method == LineSearch::strong_wolfe) {
+        rv = strong_wolfe_line_search(fun, vec, par, start, direction, state);
+    } else {
+        const auto minimum = find_minimum_on_line(fun, par, start.wssr, vec, direction, 128);
+        rv.evaluations = minimum.evaluations;
+        if (minimum.wssr < start.wssr) {
+            rv.parameters = minimum.parameters;
+            rv.value = compute_wssr_and_gradient(fun, vec, rv.parameters);
+            ++rv.evaluations;
+            rv.converged = true;
+        } else {
+            // no decrease, the solvers stop and do not need the gradient
+            rv.parameters = par;
+            rv.value = start;
+        }
+    }
+    record_line_search(recorded_data_passes() - passes);
+    return rv;
+}
+
+}  // namespace detail
+}  // namespace minimize
+
+#endif /* MINIMIZE_LINE_SEARCH_INCLUDED_HPP */
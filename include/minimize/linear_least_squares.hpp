@@ -0,0 +1,109 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_LINEAR_LEAST_SQUARES_INCLUDED_HPP
+#define MINIMIZE_LINEAR_LEAST_SQUARES_INCLUDED_HPP
+
+#include "minimize/bootstrap.hpp"
+#include "minimize/detail/linear_algebra.hpp"
+#include "minimize/detail/normal_equations.hpp"
+#include "minimize/fit_results.hpp"
+#include "minimize/function.hpp"
+#include "minimize/measurement.hpp"
+#include "minimize/observer.hpp"
+#include "minimize/solver_options.hpp"
+#include "minimize/wssr.hpp"
+
+namespace minimize {
+
+namespace detail {
+
+/**
+ * @brief Solves the normal equations of a function that is linear in its parameters.
+ *
+ * The normal equations are assembled in one pass over the data and solved with a Cholesky
+ * decomposition. For a linear function, this single step reaches the minimum from any starting point.
+ * Tolerance and iteration limit are unused, they only exist to match the signature of the other solvers.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> linear_least_squares_impl(
+    const Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
+    minimize::floating_t = 0.0, std::size_t = 1) {
+    FitRecorder recorder;
+    auto minimum = function.parameters();
+    const auto system = compute_normal_equations(function, measurements, minimum);
+    auto wssr = system.wssr;
+
+    minimize::FitResults<NumberOfParameters> results(wssr, measurements.size());
+    results.initialize_before_fit(function);
+    record_wssr(wssr);
+    auto decomposed = system.jtj;
+    const bool solved = cholesky_decomposition(decomposed);
+    if (solved) {
+        const auto next_parameters = detail::axpy(-1.0, cholesky_solve(decomposed, system.jtr), minimum);
+        const auto next_wssr = compute_wssr(function, measurements, next_parameters);
+        if (next_wssr <= wssr) {
+            minimum = next_parameters;
+            wssr = next_wssr;
+            record_wssr(wssr);
+        }
+    }
+
+    results.set_converged(solved);
+    results.set_iterations(solved ? 1 : 0);
+    results.set_weighted_sum_of_squared_residuals(wssr);
+    results.set_optimized_values(minimum);
+    recorder.finish(results);
+    return results;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Fits a function that is linear in its parameters, e.g. a Polynomial, in closed form.
+ *
+ * Instead of iterating, the normal equations J^T W J * delta = J^T W r are assembled in a single pass
+ * over the data and solved directly. The result is only the minimum if the function is linear in its
+ * parameters, use one of the iterative solvers otherwise. The fit is reported as not converged if the
+ * normal equations are singular, e.g. if there are fewer distinct positions than parameters.
+ *
+ * @param function Function to fit. The optimized parameters are stored in the function.
+ * @param measurements Measured data
+ * @return FitResults<NumberOfParameters>
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> linear_least_squares(Function<InputDimensions, NumberOfParameters>& function,
+                                                              const DataVector& measurements) {
+    return minimize::bootstrap_errors<InputDimensions, NumberOfParameters, DataVector>(
+        function, measurements,
+        minimize::detail::linear_least_squares_impl<InputDimensions, NumberOfParameters, DataVector>, 0.0, 1);
+}
+
+/** Fits a function that is linear in its parameters in closed form with the bootstrap settings and the observer
+ * of the options. The observer is called once after the solution, tolerance, iteration limit and line search are
+ * not used.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> linear_least_squares(Function<InputDimensions, NumberOfParameters>& function,
+                                                              const DataVector& measurements,
+                                                              const SolverOptions& options) {
+    return minimize::bootstrap_errors<InputDimensions, NumberOfParameters, DataVector>(
+        function, measurements,
+        [&options](const Function<InputDimensions, NumberOfParameters>& f, const DataVector& data,
+                   minimize::floating_t, std::size_t) {
+            auto results = detail::linear_least_squares_impl(f, data);
+            const auto initial = results.initial_weighted_sum_of_squared_residuals();
+            const auto wssr = results.weighted_sum_of_squared_residuals();
+            const auto rel_change = initial > 0.0 ? 1.0 - wssr / initial : 0.0;
+            if (detail::observer_stops_fit(options.observer, results.iterations(), results.optimized_values(), wssr,
+                                           rel_change)) {
+                results.set_cancelled(true);
+            }
+            return results;
+        },
+        options.bootstrap, 0.0, 1);
+}
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_LINEAR_LEAST_SQUARES_INCLUDED_HPP */
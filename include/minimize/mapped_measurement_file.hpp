@@ -0,0 +1,284 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_MAPPED_MEASUREMENT_FILE_INCLUDED_HPP
+#define MINIMIZE_MAPPED_MEASUREMENT_FILE_INCLUDED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "minimize/detail/meta.hpp"
+#include "minimize/measurement.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MINIMIZE_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define MINIMIZE_HAS_MMAP 0
+#endif
+
+namespace minimize {
+
+/**
+ * @brief Header of a binary measurement file.
+ *
+ * A measurement file consists of this 32 byte header followed by the records. All values use the
+ * byte order of the machine that writes the file.
+ *
+ * | offset | type          | content                                   |
+ * |--------|---------------|-------------------------------------------|
+ * | 0      | char[8]       | magic "MINIMIZE"                          |
+ * | 8      | uint32        | format version, currently 1               |
+ * | 12     | uint32        | number of input dimensions N              |
+ * | 16     | uint64        | number of records                         |
+ * | 24     | uint64        | reserved, 0                               |
+ * | 32     | record[]      | records of N+2 doubles: x..., y, error    |
+ */
+struct MeasurementFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t input_dimensions;
+    std::uint64_t records;
+    std::uint64_t reserved;
+};
+
+static_assert(sizeof(MeasurementFileHeader) == 32, "The file header must have a size of 32 bytes!");
+
+namespace detail {
+
+/** The first 8 bytes of a measurement file. */
+inline const char* measurement_file_magic() { return "MINIMIZE"; }
+
+constexpr std::uint32_t measurement_file_version = 1;
+
+/**
+ * @brief A read only view of a whole file.
+ *
+ * The file is memory mapped if the platform supports mmap, otherwise it is read into memory.
+ */
+class FileMapping {
+public:
+    explicit FileMapping(const std::string& path) {
+#if MINIMIZE_HAS_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open file '" + path + "'");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not read the size of file '" + path + "'");
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ > 0) {
+            void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Could not map file '" + path + "'");
+            }
+            // the solvers read the data front to back in every pass
+            ::madvise(mapping, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const unsigned char*>(mapping);
+        }
+        ::close(fd);
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            throw std::runtime_error("Could not open file '" + path + "'");
+        }
+        size_ = static_cast<std::size_t>(file.tellg());
+        buffer_.resize(size_ / sizeof(double) + 1);
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(size_))) {
+            throw std::runtime_error("Could not read file '" + path + "'");
+        }
+        data_ = reinterpret_cast<const unsigned char*>(buffer_.data());
+#endif
+    }
+
+    FileMapping(const FileMapping&) = delete;
+    FileMapping& operator=(const FileMapping&) = delete;
+
+    ~FileMapping() {
+#if MINIMIZE_HAS_MMAP
+        if (data_ != nullptr) {
+            ::munmap(const_cast<unsigned char*>(data_), size_);
+        }
+#endif
+    }
+
+    const unsigned char* data() const noexcept { return data_; }
+
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    const unsigned char* data_{nullptr};
+    std::size_t size_{0};
+#if !MINIMIZE_HAS_MMAP
+    std::vector<double> buffer_{};
+#endif
+};
+
+}  // namespace detail
+
+/**
+ * @brief Measured data with errors read from a memory mapped binary file.
+ *
+ * The file format is described at MeasurementFileHeader. The records are used in place without copying
+ * or parsing, so data sets larger than the main memory can be fitted at the bandwidth of the disk.
+ * The wssr and the gradients are the same as for a MeasurementVectorWithErrors with the same content.
+ *
+ * Copies share the mapping. The measured values can be overwritten with set_output(), which copies the
+ * values into memory owned by this object. This is only used for the bootstrap resamples, which hold the
+ * residuals and one copy of the measured values per thread in memory. Fits of mapped files therefore estimate
+ * the errors from the covariance by default, see ErrorEstimation::automatic.
+ */
+template <std::size_t InputDimensions>
+class MappedMeasurementFile {
+public:
+    using value_type = MeasurementWithError<InputDimensions>;
+    using input_t = typename value_type::input_t;
+    static constexpr std::size_t input_dimensions = InputDimensions;
+
+    static_assert(sizeof(value_type) == (InputDimensions + 2) * sizeof(double),
+                  "The records must be reinterpretable as MeasurementWithError!");
+
+    /** Read only iterator. Dereferencing returns a copy of the record. */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = MeasurementWithError<InputDimensions>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = value_type;
+
+        const_iterator(const MappedMeasurementFile* data, std::size_t index) : data_(data), index_(index) {}
+
+        value_type operator*() const { return (*data_)[index_]; }
+
+        const_iterator& operator++() {
+            ++index_;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+
+    private:
+        const MappedMeasurementFile* data_;
+        std::size_t index_;
+    };
+
+    /** Maps the file. Throws std::runtime_error if the file cannot be read or has the wrong format. */
+    explicit MappedMeasurementFile(const std::string& path) : mapping_(std::make_shared<detail::FileMapping>(path)) {
+        if (mapping_->size() < sizeof(MeasurementFileHeader)) {
+            throw std::runtime_error("File '" + path + "' is too small for a measurement file");
+        }
+        MeasurementFileHeader header;
+        std::memcpy(&header, mapping_->data(), sizeof(header));
+        if (std::memcmp(header.magic, detail::measurement_file_magic(), sizeof(header.magic)) != 0 ||
+            header.version != detail::measurement_file_version) {
+            throw std::runtime_error("File '" + path + "' is not a measurement file");
+        }
+        if (header.input_dimensions != InputDimensions) {
+            throw std::runtime_error("File '" + path + "' has " + std::to_string(header.input_dimensions) +
+                                     " input dimensions, expected " + std::to_string(InputDimensions));
+        }
+        if (header.records > (mapping_->size() - sizeof(header)) / sizeof(value_type) ||
+            mapping_->size() != sizeof(header) + header.records * sizeof(value_type)) {
+            throw std::runtime_error("The size of file '" + path + "' does not match the number of records");
+        }
+        size_ = static_cast<std::size_t>(header.records);
+        records_ = reinterpret_cast<const value_type*>(mapping_->data() + sizeof(header));
+    }
+
+    std::size_t size() const noexcept { return size_; }
+
+    bool empty() const noexcept { return size_ == 0; }
+
+    /** The records in the file. The measured values may differ if they were overwritten with set_output(). */
+    const value_type* records() const noexcept { return records_; }
+
+    const input_t& input_at(std::size_t i) const noexcept { return records_[i].in; }
+
+    floating_t output(std::size_t i) const noexcept { return outputs_.empty() ? records_[i].out : outputs_[i]; }
+
+    floating_t error(std::size_t i) const noexcept { return records_[i].error; }
+
+    /** Overwrites the measured value. The first call copies all measured values into memory. */
+    void set_output(std::size_t i, floating_t value) {
+        if (outputs_.empty()) {
+            outputs_.resize(size_);
+            for (std::size_t k = 0; k < size_; ++k) {
+                outputs_[k] = records_[k].out;
+            }
+        }
+        outputs_[i] = value;
+    }
+
+    value_type operator[](std::size_t i) const {
+        value_type rv = records_[i];
+        rv.out = output(i);
+        return rv;
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+private:
+    std::shared_ptr<detail::FileMapping> mapping_;
+    const value_type* records_{nullptr};
+    std::size_t size_{0};
+    std::vector<floating_t> outputs_{};
+};
+
+/** Writes the measurements to a binary file that can be opened with MappedMeasurementFile.
+ * Throws std::runtime_error if the file cannot be written.
+ */
+template <std::size_t InputDimensions>
+void write_measurement_file(const std::string& path, const MeasurementVectorWithErrors<InputDimensions>& data) {
+    MeasurementFileHeader header;
+    std::memcpy(header.magic, detail::measurement_file_magic(), sizeof(header.magic));
+    header.version = detail::measurement_file_version;
+    header.input_dimensions = static_cast<std::uint32_t>(InputDimensions);
+    header.records = data.size();
+    header.reserved = 0;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!data.empty()) {
+        file.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size() * sizeof(MeasurementWithError<InputDimensions>)));
+    }
+    if (!file) {
+        throw std::runtime_error("Could not write file '" + path + "'");
+    }
+}
+
+namespace detail {
+
+template <std::size_t InputDimensions>
+struct is_out_of_core<MappedMeasurementFile<InputDimensions>> {
+    static constexpr bool value = true;
+};
+
+}  // namespace detail
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_MAPPED_MEASUREMENT_FILE_INCLUDED_HPP */
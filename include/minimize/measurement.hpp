@@ -34,6 +34,30 @@ using MeasurementVector = std::vector<Measurement<InputDimensions>>;
 template <std::size_t InputDimensions>
 using MeasurementVectorWithErrors = std::vector<MeasurementWithError<InputDimensions>>;
 
+namespace detail {
+
+/** Weight of a squared residual in the wssr. Measurements without errors have unity weights. */
+template <std::size_t InputDimensions>
+floating_t measurement_weight(const Measurement<InputDimensions>&) {
+    return 1.0;
+}
+
+/** Weight of a squared residual in the wssr: the inverse variance of the measurement. */
+template <std::size_t InputDimensions>
+floating_t measurement_weight(const MeasurementWithError<InputDimensions>& x) {
+    return 1.0 / (x.error * x.error);
+}
+
+/** True for containers whose measurements are not held in memory, e.g. memory mapped files.
+ * Methods that copy the measurements, like the bootstrap, are not used for them by default.
+ */
+template <typename DataVector>
+struct is_out_of_core {
+    static constexpr bool value = false;
+};
+
+}  // namespace detail
+
 }  // namespace minimize
 
 #endif /* MINIMIZE_MEASUREMENT_INCLUDED_HPP */
@@ -0,0 +1,224 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_MEASUREMENT_COLUMNS_INCLUDED_HPP
+#define MINIMIZE_MEASUREMENT_COLUMNS_INCLUDED_HPP
+
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+#include "minimize/detail/aligned_allocator.hpp"
+#include "minimize/detail/meta.hpp"
+#include "minimize/measurement.hpp"
+
+namespace minimize {
+
+namespace detail {
+
+template <std::size_t InputDimensions>
+struct column_access {
+    using input_t = typename ::minimize::detail::type_selection_helper<InputDimensions>::type;
+
+    template <typename Columns>
+    static input_t gather(const Columns& columns, std::size_t i) {
+        input_t rv;
+        for (std::size_t d = 0; d < InputDimensions; ++d) {
+            rv[d] = static_cast<floating_t>(columns[d][i]);
+        }
+        return rv;
+    }
+
+    template <typename Columns>
+    static void scatter(Columns& columns, const input_t& x) {
+        using scalar_t = typename Columns::value_type::value_type;
+        for (std::size_t d = 0; d < InputDimensions; ++d) {
+            columns[d].push_back(static_cast<scalar_t>(x[d]));
+        }
+    }
+
+    /** Copies the positions [begin, begin + count) into the buffer and returns the buffer. */
+    template <typename Columns>
+    static const input_t* gather_range(const Columns& columns, std::size_t begin, std::size_t count,
+                                       input_t* buffer) {
+        for (std::size_t i = 0; i < count; ++i) {
+            buffer[i] = gather(columns, begin + i);
+        }
+        return buffer;
+    }
+};
+
+template <>
+struct column_access<1> {
+    using input_t = floating_t;
+
+    template <typename Columns>
+    static input_t gather(const Columns& columns, std::size_t i) {
+        return static_cast<floating_t>(columns[0][i]);
+    }
+
+    template <typename Columns>
+    static void scatter(Columns& columns, const input_t& x) {
+        using scalar_t = typename Columns::value_type::value_type;
+        columns[0].push_back(static_cast<scalar_t>(x));
+    }
+
+    template <typename Columns>
+    static const input_t* gather_range(const Columns& columns, std::size_t begin, std::size_t count,
+                                       input_t* buffer) {
+        return convert_range(columns[0].data() + begin, count, buffer);
+    }
+
+    /** One dimensional positions stored as floating_t are already contiguous, nothing is copied. */
+    static const input_t* convert_range(const floating_t* positions, std::size_t, input_t*) { return positions; }
+
+    /** Positions stored with another type are converted into the buffer. */
+    template <typename Scalar>
+    static const input_t* convert_range(const Scalar* positions, std::size_t count, input_t* buffer) {
+        for (std::size_t i = 0; i < count; ++i) {
+            buffer[i] = static_cast<floating_t>(positions[i]);
+        }
+        return buffer;
+    }
+};
+
+}  // namespace detail
+
+/**
+ * @brief Measured data stored as a structure of arrays.
+ *
+ * Every input dimension, the measured values and the weights are stored in separate contiguous
+ * arrays that are aligned to cache lines. The weights are the inverse variances 1/error^2 of the
+ * measurements, or 1 if the data has no errors. The wssr of this container is the sum of
+ * weight * (f(x)-y)^2.
+ *
+ * Iterating over the container yields MeasurementWithError values, so it can be used everywhere
+ * a DataVector is accepted.
+ *
+ * The values are stored as Scalar. With float, the data needs half the memory and memory bandwidth.
+ * The function is still evaluated with floating_t: every value is converted when it is read, and
+ * all sums of the wssr and its gradient are computed with floating_t.
+ */
+template <std::size_t InputDimensions, typename Scalar = floating_t>
+class MeasurementColumns {
+public:
+    using input_t = typename ::minimize::detail::type_selection_helper<InputDimensions>::type;
+    using scalar_t = Scalar;
+    using column_t = std::vector<Scalar, detail::AlignedAllocator<Scalar>>;
+    using value_type = MeasurementWithError<InputDimensions>;
+    static constexpr std::size_t input_dimensions = InputDimensions;
+
+    /** Read only iterator. Dereferencing creates a MeasurementWithError from the columns. */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = MeasurementWithError<InputDimensions>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = value_type;
+
+        const_iterator(const MeasurementColumns* data, std::size_t index) : data_(data), index_(index) {}
+
+        value_type operator*() const { return (*data_)[index_]; }
+
+        const_iterator& operator++() {
+            ++index_;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto copy = *this;
+            ++index_;
+            return copy;
+        }
+
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+
+    private:
+        const MeasurementColumns* data_;
+        std::size_t index_;
+    };
+
+    MeasurementColumns() = default;
+
+    /** Copies the data. All weights are 1. */
+    explicit MeasurementColumns(const MeasurementVector<InputDimensions>& vec) {
+        reserve(vec.size());
+        for (const auto& x : vec) {
+            push_back(x.in, x.out);
+        }
+    }
+
+    /** Copies the data. The weights are computed from the errors. */
+    explicit MeasurementColumns(const MeasurementVectorWithErrors<InputDimensions>& vec) {
+        reserve(vec.size());
+        for (const auto& x : vec) {
+            push_back(x.in, x.out, 1.0 / (x.error * x.error));
+        }
+    }
+
+    void reserve(std::size_t n) {
+        for (auto& column : inputs_) {
+            column.reserve(n);
+        }
+        outputs_.reserve(n);
+        weights_.reserve(n);
+    }
+
+    /** Appends a measurement at position in with the measured value out and the given weight (1/error^2). */
+    void push_back(const input_t& in, floating_t out, floating_t weight = 1.0) {
+        detail::column_access<InputDimensions>::scatter(inputs_, in);
+        outputs_.push_back(static_cast<Scalar>(out));
+        weights_.push_back(static_cast<Scalar>(weight));
+    }
+
+    std::size_t size() const noexcept { return outputs_.size(); }
+
+    bool empty() const noexcept { return outputs_.empty(); }
+
+    /** Contiguous array with the values of the given input dimension. */
+    const Scalar* input(std::size_t dimension) const noexcept { return inputs_[dimension].data(); }
+
+    /** Contiguous array with the measured values. */
+    const Scalar* outputs() const noexcept { return outputs_.data(); }
+
+    /** Contiguous array with the weights. */
+    const Scalar* weights() const noexcept { return weights_.data(); }
+
+    input_t input_at(std::size_t i) const { return detail::column_access<InputDimensions>::gather(inputs_, i); }
+
+    /** Returns the positions [begin, begin + count) as contiguous array.
+     * The positions are copied to buffer unless they are already stored contiguously.
+     */
+    const input_t* inputs(std::size_t begin, std::size_t count, input_t* buffer) const {
+        return detail::column_access<InputDimensions>::gather_range(inputs_, begin, count, buffer);
+    }
+
+    floating_t output(std::size_t i) const noexcept { return static_cast<floating_t>(outputs_[i]); }
+
+    floating_t weight(std::size_t i) const noexcept { return static_cast<floating_t>(weights_[i]); }
+
+    void set_output(std::size_t i, floating_t value) noexcept { outputs_[i] = static_cast<Scalar>(value); }
+
+    value_type operator[](std::size_t i) const {
+        value_type rv;
+        rv.in = input_at(i);
+        rv.out = output(i);
+        rv.error = 1.0 / std::sqrt(weight(i));
+        return rv;
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+private:
+    std::array<column_t, InputDimensions> inputs_{};
+    column_t outputs_{};
+    column_t weights_{};
+};
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_MEASUREMENT_COLUMNS_INCLUDED_HPP */
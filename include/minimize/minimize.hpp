@@ -6,11 +6,27 @@
 
 // Primary include file for minimize
 
+#include "minimize/autodiff_function.hpp"
 #include "minimize/bootstrap.hpp"
 #include "minimize/conjugate_gradient_descent.hpp"
+#include "minimize/dual.hpp"
+#include "minimize/fit_many.hpp"
 #include "minimize/function.hpp"
+#include "minimize/instrumentation.hpp"
+#include "minimize/lbfgs.hpp"
+#include "minimize/levenberg_marquardt.hpp"
+#include "minimize/line_search.hpp"
+#include "minimize/linear_least_squares.hpp"
+#include "minimize/mapped_measurement_file.hpp"
 #include "minimize/measurement.hpp"
+#include "minimize/measurement_columns.hpp"
+#include "minimize/observer.hpp"
+#include "minimize/simd.hpp"
+#include "minimize/solver_options.hpp"
 #include "minimize/steepest_descent.hpp"
+#include "minimize/stochastic_gradient_descent.hpp"
+#include "minimize/thread_pool.hpp"
+#include "minimize/variable_projection.hpp"
 #include "minimize/wssr.hpp"
 
 #endif /* MINIMIZE_INCLUDED_HPP */
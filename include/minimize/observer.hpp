@@ -0,0 +1,80 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_OBSERVER_INCLUDED_HPP
+#define MINIMIZE_OBSERVER_INCLUDED_HPP
+
+#include <cstddef>
+#include <functional>
+
+#include "minimize/detail/meta.hpp"
+
+namespace minimize {
+
+/** Return value of an observer. */
+enum class ObserverAction {
+    /** Continue the fit. */
+    proceed,
+    /** Cancel the fit. The results hold the best parameters found so far and are marked as cancelled. */
+    stop
+};
+
+/** State of a fit passed to an observer. */
+struct FitProgress {
+    /** Number of finished iterations of the fit, or of finished resamples of the bootstrap. */
+    std::size_t iteration{0};
+    /** The current parameters, an array of number_of_parameters values. Only valid during the call. */
+    const floating_t* parameters{nullptr};
+    std::size_t number_of_parameters{0};
+    /** The wssr at the current parameters. */
+    floating_t wssr{0.0};
+    /** Relative change of the wssr in the last iteration. 0 for the bootstrap. */
+    floating_t relative_change{0.0};
+};
+
+/** Callback that observes the progress of a fit. Returning ObserverAction::stop cancels the fit. */
+using FitObserver = std::function<ObserverAction(const FitProgress&)>;
+
+namespace detail {
+
+/** True while a bootstrap resample is fitted on this thread. The iteration observers only watch the main fit. */
+inline bool& resample_fit_active() noexcept {
+    static thread_local bool rv = false;
+    return rv;
+}
+
+/** Marks the fits on this thread as bootstrap resamples while it exists. */
+class ResampleFitScope {
+public:
+    ResampleFitScope() : previous_(resample_fit_active()) { resample_fit_active() = true; }
+
+    ResampleFitScope(const ResampleFitScope&) = delete;
+    ResampleFitScope& operator=(const ResampleFitScope&) = delete;
+
+    ~ResampleFitScope() { resample_fit_active() = previous_; }
+
+private:
+    bool previous_;
+};
+
+/** Calls the observer of an iteration of the main fit. Returns true if the observer cancels the fit. */
+template <std::size_t NumberOfParameters>
+bool observer_stops_fit(const FitObserver& observer, std::size_t iteration,
+                        const parameter_t<NumberOfParameters>& parameters, floating_t wssr,
+                        floating_t relative_change) {
+    if (!observer || resample_fit_active()) {
+        return false;
+    }
+    FitProgress progress;
+    progress.iteration = iteration;
+    progress.parameters = parameters.data();
+    progress.number_of_parameters = NumberOfParameters;
+    progress.wssr = wssr;
+    progress.relative_change = relative_change;
+    return observer(progress) == ObserverAction::stop;
+}
+
+}  // namespace detail
+}  // namespace minimize
+
+#endif /* MINIMIZE_OBSERVER_INCLUDED_HPP */
@@ -0,0 +1,119 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_SIMD_INCLUDED_HPP
+#define MINIMIZE_SIMD_INCLUDED_HPP
+
+#include <atomic>
+#include <cstddef>
+
+#include "minimize/detail/meta.hpp"
+#include "minimize/detail/simd_kernels.hpp"
+
+namespace minimize {
+
+/** Instruction sets of the reduction kernels of the wssr, ordered by width. */
+enum class SimdLevel { scalar = 0, sse2 = 1, avx2 = 2, avx512 = 3 };
+
+namespace detail {
+
+/** Function pointers to the reduction kernels of one instruction set. */
+struct SimdKernels {
+    /** Sum of x[0, n). */
+    floating_t (*sum)(const floating_t* x, std::size_t n);
+    /** Sum of (values[i] - outputs[i])^2. */
+    floating_t (*sum_squared_differences)(const floating_t* values, const floating_t* outputs, std::size_t n);
+    /** Sum of weights[i] * (values[i] - outputs[i])^2. */
+    floating_t (*sum_weighted_squared_differences)(const floating_t* values, const floating_t* outputs,
+                                                   const floating_t* weights, std::size_t n);
+    /** Adds factors[i] * rows[i] to out for all count rows with the given number of columns. */
+    void (*add_scaled_rows)(floating_t* out, const floating_t* factors, const floating_t* rows, std::size_t count,
+                            std::size_t columns);
+};
+
+template <typename Kernels>
+const SimdKernels& make_simd_kernels() noexcept {
+    static const SimdKernels rv = {&Kernels::sum, &Kernels::sum_squared_differences,
+                                   &Kernels::sum_weighted_squared_differences, &Kernels::add_scaled_rows};
+    return rv;
+}
+
+/** The widest instruction set supported by the compiler and the processor. */
+inline SimdLevel detect_simd_level() noexcept {
+#if MINIMIZE_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::sse2;
+    }
+#endif
+    return SimdLevel::scalar;
+}
+
+inline SimdLevel supported_simd_level() noexcept {
+    static const SimdLevel rv = detect_simd_level();
+    return rv;
+}
+
+/** The kernels of the given instruction set. Must not be wider than supported_simd_level(). */
+inline const SimdKernels& simd_kernels(SimdLevel level) noexcept {
+#if MINIMIZE_SIMD_X86
+    switch (level) {
+        case SimdLevel::avx512:
+            return make_simd_kernels<Avx512Kernels>();
+        case SimdLevel::avx2:
+            return make_simd_kernels<Avx2Kernels>();
+        case SimdLevel::sse2:
+            return make_simd_kernels<Sse2Kernels>();
+        case SimdLevel::scalar:
+            break;
+    }
+#else
+    (void)level;
+#endif
+    return make_simd_kernels<ScalarKernels>();
+}
+
+inline std::atomic<SimdLevel>& active_simd_level() noexcept {
+    static std::atomic<SimdLevel> rv{supported_simd_level()};
+    return rv;
+}
+
+/** The kernels used by the wssr. */
+inline const SimdKernels& simd_kernels() noexcept {
+    return simd_kernels(active_simd_level().load(std::memory_order_relaxed));
+}
+
+}  // namespace detail
+
+/** Returns the instruction set used by the reduction kernels of the wssr. */
+inline SimdLevel simd_level() noexcept { return detail::active_simd_level().load(std::memory_order_relaxed); }
+
+/**
+ * @brief Selects the instruction set of the reduction kernels of the wssr.
+ *
+ * The default is the widest instruction set supported by the processor. Wider levels than supported are
+ * lowered to the supported level. All levels compute bit identical results, unless the compiler is allowed to
+ * contract multiplications and additions into fused multiply-adds (e.g. -ffp-contract=fast with -mfma).
+ * Do not call this method while a fit is running.
+ *
+ * @param level requested instruction set
+ * @return the selected instruction set
+ */
+inline SimdLevel set_simd_level(SimdLevel level) noexcept {
+    const auto supported = detail::supported_simd_level();
+    if (static_cast<int>(level) > static_cast<int>(supported)) {
+        level = supported;
+    }
+    detail::active_simd_level().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_SIMD_INCLUDED_HPP */
@@ -0,0 +1,100 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_SOLVER_OPTIONS_INCLUDED_HPP
+#define MINIMIZE_SOLVER_OPTIONS_INCLUDED_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "minimize/bootstrap.hpp"
+#include "minimize/detail/meta.hpp"
+#include "minimize/observer.hpp"
+
+namespace minimize {
+
+/** Strategy used by the gradient descent solvers to find the next point along the search direction. */
+enum class LineSearch {
+    /** Each solver uses the search that suits it: strong_wolfe for lbfgs(), bracketing for the other solvers. */
+    automatic,
+    /** Expands an interval until it brackets the minimum, then shrinks it with parabolic steps.
+     * Only uses the wssr, but needs many passes over the data.
+     */
+    bracketing,
+    /** Uses the directional derivatives and stops as soon as the strong Wolfe conditions hold.
+     * The initial step is warm-started from the step accepted in the previous iteration.
+     */
+    strong_wolfe
+};
+
+/** Update rule of stochastic_gradient_descent(). */
+enum class StochasticUpdate {
+    /** Gradient descent with momentum: v = momentum * v + g, p = p - rate * v. */
+    momentum,
+    /** Adam: steps with the bias corrected first moment of the gradients divided by the root of the second moment.
+     * The step size is about the learning rate, independent of the scale of the gradients.
+     */
+    adam
+};
+
+/** Settings of stochastic_gradient_descent(). */
+struct StochasticOptions {
+    /** Update rule. */
+    StochasticUpdate update{StochasticUpdate::adam};
+
+    /** Number of measurements used for the gradient of one step. */
+    std::size_t batch_size{1024};
+
+    /** Step size of the first step. The gradient of a batch is the mean over its measurements. */
+    minimize::floating_t learning_rate{1e-2};
+
+    /** Learning rate schedule: step t uses learning_rate / (1 + decay * t). 0 keeps the rate constant. */
+    minimize::floating_t decay{0.0};
+
+    /** Momentum of the momentum update, decay rate of the first moment of Adam. */
+    minimize::floating_t momentum{0.9};
+
+    /** Decay rate of the second moment of Adam. */
+    minimize::floating_t second_moment_decay{0.999};
+
+    /** Added to the root of the second moment of Adam to avoid divisions by zero. */
+    minimize::floating_t epsilon{1e-8};
+
+    /** Number of steps between two passes over all measurements that compute the wssr to check the convergence. */
+    std::size_t evaluation_interval{100};
+
+    /** The fit stops without convergence after this many checks in a row that do not improve the lowest wssr.
+     * A single check without improvement is normal for noisy batch gradients.
+     */
+    std::size_t patience{5};
+
+    /** Seed of the generator that shuffles the order of the measurements in every epoch. */
+    std::uint64_t seed{5489u};
+};
+
+/** Settings shared by the solvers. */
+struct SolverOptions {
+    /** The fit stops if the relative change of the wssr is below this value. */
+    minimize::floating_t tolerance{1e-15};
+
+    /** Iteration limit. */
+    std::size_t max_iterations{16535};
+
+    /** Line search of steepest_descent(), conjugate_gradient_descent() and lbfgs(). Other solvers ignore it. */
+    LineSearch line_search{LineSearch::automatic};
+
+    /** Settings of stochastic_gradient_descent(). Other solvers ignore it. */
+    StochasticOptions stochastic{};
+
+    /** Settings for the error estimation. */
+    BootstrapOptions bootstrap{};
+
+    /** Called after every iteration of the fit, see FitProgress. Returning ObserverAction::stop cancels the fit
+     * and the bootstrap. fit_many() calls the observer concurrently from several threads.
+     */
+    FitObserver observer{};
+};
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_SOLVER_OPTIONS_INCLUDED_HPP */
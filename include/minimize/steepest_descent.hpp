@@ -5,9 +5,11 @@
 #define MINIMIZE_STEEPEST_DESCENT_INCLUDED_HPP
 
 #include "minimize/bootstrap.hpp"
-#include "minimize/find_minimum_on_line.hpp"
 #include "minimize/function.hpp"
+#include "minimize/line_search.hpp"
 #include "minimize/measurement.hpp"
+#include "minimize/observer.hpp"
+#include "minimize/solver_options.hpp"
 #include "minimize/wssr.hpp"
 
 namespace minimize {
@@ -17,47 +19,82 @@ namespace detail {
 template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
 minimize::FitResults<NumberOfParameters> steepest_descent_impl(
     const Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
-    minimize::floating_t tolerance = 1e-15, std::size_t max_iterations = 16535) {
+    const SolverOptions& options) {
+    FitRecorder recorder;
     auto minimum = function.parameters();
     std::size_t iterations = 0;
 
-    auto wssr = compute_wssr(function, measurements);
+    auto current = compute_wssr_and_gradient(function, measurements, minimum);
+    auto wssr = current.wssr;
 
     minimize::FitResults<NumberOfParameters> results(wssr, measurements.size());
     results.initialize_before_fit(function);
-    auto rel_change = 10.0 * tolerance;
+    record_wssr(wssr);
+    LineSearchState state;
+    auto rel_change = 10.0 * options.tolerance;
+    bool cancelled = false;
     do {
-        auto gradient = compute_wssr_gradient(function, measurements, minimum);
-        const auto next_parameters = find_minimum_on_line(function, minimum, measurements, gradient, 128);
-        const auto next_wssr = compute_wssr(function, measurements, next_parameters);
+        const auto next = line_search(function, measurements, minimum, current, current.gradient,
+                                      options.line_search, state);
+        const auto next_wssr = next.value.wssr;
         if (next_wssr >= wssr || wssr == 0.0) {
             break;
         }
-        minimum = next_parameters;
+        minimum = next.parameters;
+        current = next.value;
         rel_change = 1.0 - next_wssr / wssr;
         wssr = next_wssr;
+        record_wssr(wssr);
 
         ++iterations;
-    } while (iterations < max_iterations && tolerance < rel_change);
+        if (observer_stops_fit(options.observer, iterations, minimum, wssr, rel_change)) {
+            cancelled = true;
+            break;
+        }
+    } while (iterations < options.max_iterations && options.tolerance < rel_change);
 
-    results.set_converged(iterations < max_iterations);
+    results.set_converged(iterations < options.max_iterations && !cancelled);
+    results.set_cancelled(cancelled);
     results.set_iterations(iterations);
     results.set_weighted_sum_of_squared_residuals(wssr);
     results.set_optimized_values(minimum);
+    recorder.finish(results);
     return results;
 }
 
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> steepest_descent_impl(
+    const Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
+    minimize::floating_t tolerance = 1e-15, std::size_t max_iterations = 16535) {
+    SolverOptions options;
+    options.tolerance = tolerance;
+    options.max_iterations = max_iterations;
+    return steepest_descent_impl(function, measurements, options);
+}
+
 }  // namespace detail
 
+/** Fits the function parameters by steepest descent with the given options. */
 template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
 minimize::FitResults<NumberOfParameters> steepest_descent(Function<InputDimensions, NumberOfParameters>& function,
                                                           const DataVector& measurements,
-                                                          minimize::floating_t tolerance = 1e-15,
-                                                          std::size_t max_iterations = 16535) {
+                                                          const SolverOptions& options) {
     return minimize::bootstrap_errors<InputDimensions, NumberOfParameters, DataVector>(
         function, measurements,
-        minimize::detail::steepest_descent_impl<InputDimensions, NumberOfParameters, DataVector>, tolerance,
-        max_iterations);
+        [&options](const Function<InputDimensions, NumberOfParameters>& f, const DataVector& data,
+                   minimize::floating_t, std::size_t) { return detail::steepest_descent_impl(f, data, options); },
+        options.bootstrap, options.tolerance, options.max_iterations);
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> steepest_descent(Function<InputDimensions, NumberOfParameters>& function,
+                                                          const DataVector& measurements,
+                                                          minimize::floating_t tolerance = 1e-15,
+                                                          std::size_t max_iterations = 16535) {
+    SolverOptions options;
+    options.tolerance = tolerance;
+    options.max_iterations = max_iterations;
+    return steepest_descent(function, measurements, options);
 }
 
 }  // namespace minimize
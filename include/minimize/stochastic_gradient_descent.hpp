@@ -0,0 +1,256 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_STOCHASTIC_GRADIENT_DESCENT_INCLUDED_HPP
+#define MINIMIZE_STOCHASTIC_GRADIENT_DESCENT_INCLUDED_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "minimize/bootstrap.hpp"
+#include "minimize/detail/vector_math.hpp"
+#include "minimize/fit_results.hpp"
+#include "minimize/function.hpp"
+#include "minimize/measurement.hpp"
+#include "minimize/observer.hpp"
+#include "minimize/solver_options.hpp"
+#include "minimize/wssr.hpp"
+
+namespace minimize {
+
+namespace detail {
+
+/** Moments of the gradients kept between the steps of stochastic_gradient_descent(). */
+template <std::size_t NumberOfParameters>
+class StochasticUpdater {
+public:
+    using parameter_t = minimize::parameter_t<NumberOfParameters>;
+
+    explicit StochasticUpdater(const StochasticOptions& options) : options_(options) {
+        first_moment_.fill(0.0);
+        second_moment_.fill(0.0);
+    }
+
+    /** Moves the parameters against the gradient of a batch with the given learning rate. */
+    void step(parameter_t& parameters, const parameter_t& gradient, minimize::floating_t rate) {
+        if (options_.update == StochasticUpdate::momentum) {
+            for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+                first_moment_[i] = options_.momentum * first_moment_[i] + gradient[i];
+                parameters[i] -= rate * first_moment_[i];
+            }
+            return;
+        }
+        first_power_ *= options_.momentum;
+        second_power_ *= options_.second_moment_decay;
+        for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+            first_moment_[i] = options_.momentum * first_moment_[i] + (1.0 - options_.momentum) * gradient[i];
+            second_moment_[i] = options_.second_moment_decay * second_moment_[i] +
+                                (1.0 - options_.second_moment_decay) * gradient[i] * gradient[i];
+            const auto mean = first_moment_[i] / (1.0 - first_power_);
+            const auto variance = second_moment_[i] / (1.0 - second_power_);
+            parameters[i] -= rate * mean / (std::sqrt(variance) + options_.epsilon);
+        }
+    }
+
+private:
+    const StochasticOptions& options_;
+    parameter_t first_moment_;
+    parameter_t second_moment_;
+    minimize::floating_t first_power_{1.0};
+    minimize::floating_t second_power_{1.0};
+};
+
+/**
+ * @brief Keyed pseudo-random permutation of the measurement indices.
+ *
+ * The indices are encrypted with a balanced Feistel network of four rounds over the smallest power of two with
+ * an even number of bits that holds all indices. Results outside of [0, size) are encrypted again (cycle
+ * walking), which keeps the map a bijection on the indices. Every epoch draws new round keys, so each epoch
+ * visits every index once in a new order. The permutation needs no memory per measurement, so it also suits
+ * mapped files with more measurements than fit in memory.
+ */
+class EpochPermutation {
+public:
+    explicit EpochPermutation(std::size_t size) noexcept : size_(size) {
+        while (half_bits_ < 32 && (std::uint64_t{1} << (2 * half_bits_)) < size_) {
+            ++half_bits_;
+        }
+        half_mask_ = (std::uint64_t{1} << half_bits_) - 1;
+    }
+
+    /** Draws the permutation of the next epoch and restarts at its first index. */
+    template <typename Generator>
+    void shuffle(Generator& generator) {
+        std::uniform_int_distribution<std::uint64_t> keys;
+        for (auto& key : keys_) {
+            key = keys(generator);
+        }
+        position_ = 0;
+    }
+
+    /** Returns the next index of the epoch. */
+    std::size_t next() noexcept {
+        auto rv = encrypt(position_++);
+        while (rv >= size_) {
+            rv = encrypt(rv);
+        }
+        return static_cast<std::size_t>(rv);
+    }
+
+private:
+    /** Round function: the finalizer of splitmix64. */
+    static std::uint64_t mix(std::uint64_t x) noexcept {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    std::uint64_t encrypt(std::uint64_t x) const noexcept {
+        auto left = x >> half_bits_;
+        auto right = x & half_mask_;
+        for (const auto key : keys_) {
+            const auto next = left ^ (mix(right ^ key) & half_mask_);
+            left = right;
+            right = next;
+        }
+        return (left << half_bits_) | right;
+    }
+
+    std::uint64_t size_;
+    std::uint64_t half_bits_{1};
+    std::uint64_t half_mask_{1};
+    std::array<std::uint64_t, 4> keys_{};
+    std::uint64_t position_{0};
+};
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> stochastic_gradient_descent_impl(
+    const Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
+    const SolverOptions& options) {
+    FitRecorder recorder;
+    const auto& settings = options.stochastic;
+    auto parameters = function.parameters();
+    auto minimum = parameters;
+    auto wssr = compute_wssr(function, measurements, minimum);
+
+    minimize::FitResults<NumberOfParameters> results(wssr, measurements.size());
+    results.initialize_before_fit(function);
+    record_wssr(wssr);
+
+    const std::size_t size = measurements.size();
+    const std::size_t batch = std::max<std::size_t>(1, std::min(settings.batch_size, size));
+    const std::size_t interval = std::max<std::size_t>(1, settings.evaluation_interval);
+    EpochPermutation order(size);
+    std::vector<std::size_t> indices(batch);
+    std::mt19937_64 generator{settings.seed};
+    StochasticUpdater<NumberOfParameters> updater(settings);
+
+    const std::size_t patience = std::max<std::size_t>(1, settings.patience);
+    std::size_t checks_without_improvement = 0;
+    bool stalled = false;
+    minimize::floating_t rel_change = 0.0;
+    // checks the wssr of all measurements, returns true if the relative improvement of the lowest wssr is below
+    // the tolerance. Sets stalled after patience checks in a row without improvement.
+    auto converged_at_check = [&]() {
+        const auto next_wssr = compute_wssr(function, measurements, parameters);
+        if (!(next_wssr < wssr)) {
+            rel_change = 0.0;
+            ++checks_without_improvement;
+            stalled = checks_without_improvement >= patience;
+            return false;
+        }
+        checks_without_improvement = 0;
+        rel_change = 1.0 - next_wssr / wssr;
+        minimum = parameters;
+        wssr = next_wssr;
+        record_wssr(wssr);
+        return !(options.tolerance < rel_change);
+    };
+
+    std::size_t iterations = 0;
+    std::size_t position = size;
+    bool converged = size == 0 || wssr == 0.0;
+    bool cancelled = false;
+    while (!converged && !stalled && iterations < options.max_iterations) {
+        if (position == size) {
+            order.shuffle(generator);
+            position = 0;
+        }
+        const std::size_t count = std::min(batch, size - position);
+        // the sum does not depend on the order, sorting keeps the memory accesses of a batch ascending
+        for (std::size_t i = 0; i < count; ++i) {
+            indices[i] = order.next();
+        }
+        std::sort(indices.begin(), indices.begin() + count);
+        position += count;
+
+        WssrAndGradient<NumberOfParameters> sample;
+        sample.gradient.fill(0.0);
+        add_wssr_and_gradient_at(function, measurements, parameters, indices.data(), count, sample);
+        const auto steps = static_cast<minimize::floating_t>(iterations);
+        const auto rate = settings.learning_rate / (1.0 + settings.decay * steps);
+        const auto scale = 1.0 / static_cast<minimize::floating_t>(count);
+        updater.step(parameters, detail::scale_vector(scale, sample.gradient), rate);
+        ++iterations;
+
+        if (iterations % interval == 0 || iterations == options.max_iterations) {
+            converged = converged_at_check();
+            if (observer_stops_fit(options.observer, iterations, minimum, wssr, rel_change)) {
+                cancelled = true;
+                break;
+            }
+        }
+    }
+
+    results.set_converged(converged);
+    results.set_cancelled(cancelled);
+    results.set_iterations(iterations);
+    results.set_weighted_sum_of_squared_residuals(wssr);
+    results.set_optimized_values(minimum);
+    recorder.finish(results);
+    return results;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Fits the function parameters with mini-batch stochastic gradient descent.
+ *
+ * Every step computes the gradient of a batch of measurements and updates the parameters with momentum or Adam,
+ * see StochasticOptions. The batches are drawn from a pseudo-random permutation of the measurements that changes
+ * at the start of every epoch, so each measurement is used once per epoch. The cost of a step only depends on
+ * the batch size, which makes the solver suitable for data sets where a single pass over all measurements is
+ * expensive.
+ *
+ * The wssr of all measurements is only computed every evaluation_interval steps. The fit converges if a check
+ * improves the lowest wssr by less than the tolerance. It stops without convergence after max_iterations steps,
+ * or if patience checks in a row do not improve the lowest wssr. The result holds the parameters with the lowest
+ * checked wssr.
+ * The permutation is generated on the fly, the extra memory only depends on the batch size.
+ *
+ * @param function Function to fit. The optimized parameters are stored in the function.
+ * @param measurements Measured data
+ * @param options settings of the fit, the solver specific settings are in options.stochastic
+ * @return FitResults<NumberOfParameters>
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> stochastic_gradient_descent(
+    Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
+    const SolverOptions& options) {
+    return minimize::bootstrap_errors<InputDimensions, NumberOfParameters, DataVector>(
+        function, measurements,
+        [&options](const Function<InputDimensions, NumberOfParameters>& f, const DataVector& data,
+                   minimize::floating_t, std::size_t) {
+            return detail::stochastic_gradient_descent_impl(f, data, options);
+        },
+        options.bootstrap, options.tolerance, options.max_iterations);
+}
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_STOCHASTIC_GRADIENT_DESCENT_INCLUDED_HPP */
@@ -0,0 +1,203 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_THREAD_POOL_INCLUDED_HPP
+#define MINIMIZE_THREAD_POOL_INCLUDED_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace minimize {
+
+/**
+ * @brief A fixed set of worker threads that execute loops in parallel.
+ *
+ * The thread calling parallel_for() takes part in the work, so a pool of size 1
+ * does not start any threads. Calls to parallel_for() from inside a running task
+ * are executed serially by the calling worker and report worker index 0.
+ * A loop uses at most concurrency(count) workers, so per worker buffers need only that many entries.
+ */
+class ThreadPool {
+public:
+    /** Task signature: index of the loop iteration and index of the executing worker in [0, size()). */
+    using task_t = std::function<void(std::size_t, std::size_t)>;
+
+    /** Creates a pool with the given total number of threads, including the calling thread. */
+    explicit ThreadPool(std::size_t threads) : size_(threads > 0 ? threads : 1) {
+        workers_.reserve(size_ - 1);
+        for (std::size_t i = 1; i < size_; ++i) {
+            workers_.emplace_back([this, i]() { worker_loop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_up_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    std::size_t size() const noexcept { return size_; }
+
+    /** Number of workers that execute parallel_for(count, ...). The reported worker indices are below it. */
+    std::size_t concurrency(std::size_t count) const noexcept {
+        if (count <= 1 || current_pool() != nullptr) {
+            return 1;
+        }
+        return std::min(size_, count);
+    }
+
+    /**
+     * @brief Calls task(index, worker) for every index in [0, count) and waits until all calls are done.
+     *
+     * Indices are handed out dynamically, so the order of execution is unspecified. If a task throws,
+     * the remaining indices are skipped and the first exception is rethrown in the calling thread.
+     */
+    void parallel_for(std::size_t count, const task_t& task) {
+        const std::size_t workers = concurrency(count);
+        if (workers == 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                task(i, 0);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> serialize(submit_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            count_ = count;
+            active_workers_ = workers;
+            next_index_ = 0;
+            error_ = nullptr;
+            busy_workers_ = workers_.size();
+            ++generation_;
+        }
+        wake_up_.notify_all();
+        run_tasks(0);
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return busy_workers_ == 0; });
+        task_ = nullptr;
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    struct WorkerScope {
+        explicit WorkerScope(ThreadPool* pool) { current_pool() = pool; }
+        ~WorkerScope() { current_pool() = nullptr; }
+    };
+
+    static ThreadPool*& current_pool() {
+        static thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    void worker_loop(std::size_t worker) {
+        std::size_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_up_.wait(lock, [this, seen_generation]() { return stop_ || generation_ != seen_generation; });
+                if (stop_) {
+                    return;
+                }
+                seen_generation = generation_;
+            }
+            if (worker < active_workers_) {
+                run_tasks(worker);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --busy_workers_;
+            }
+            done_.notify_one();
+        }
+    }
+
+    void run_tasks(std::size_t worker) {
+        WorkerScope scope(this);
+        while (true) {
+            const std::size_t index = next_index_.fetch_add(1);
+            if (index >= count_) {
+                return;
+            }
+            try {
+                (*task_)(index, worker);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                next_index_ = count_;
+            }
+        }
+    }
+
+    std::size_t size_;
+    std::vector<std::thread> workers_;
+    std::mutex submit_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_up_;
+    std::condition_variable done_;
+    const task_t* task_{nullptr};
+    std::size_t count_{0};
+    std::size_t active_workers_{0};
+    std::atomic<std::size_t> next_index_{0};
+    std::size_t busy_workers_{0};
+    std::size_t generation_{0};
+    std::exception_ptr error_{};
+    bool stop_{false};
+};
+
+namespace detail {
+
+inline std::unique_ptr<ThreadPool>& global_thread_pool_storage() {
+    static std::unique_ptr<ThreadPool> pool{new ThreadPool(1)};
+    return pool;
+}
+
+/** The pool used by the library for parallel work. */
+inline ThreadPool& global_thread_pool() { return *global_thread_pool_storage(); }
+
+}  // namespace detail
+
+/**
+ * @brief Sets the number of threads used by the library, including the calling thread.
+ *
+ * The default is 1, so all computations run in the calling thread. Functions are evaluated
+ * concurrently if the value is larger than 1, so Function::evaluate must be thread safe.
+ * Do not call this method while a fit is running.
+ */
+inline void set_thread_count(std::size_t threads) {
+    auto& pool = detail::global_thread_pool_storage();
+    if (threads == 0) {
+        threads = 1;
+    }
+    if (pool->size() != threads) {
+        pool.reset();
+        pool.reset(new ThreadPool(threads));
+    }
+}
+
+/** Returns the number of threads used by the library. */
+inline std::size_t thread_count() { return detail::global_thread_pool().size(); }
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_THREAD_POOL_INCLUDED_HPP */
@@ -0,0 +1,252 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#ifndef MINIMIZE_VARIABLE_PROJECTION_INCLUDED_HPP
+#define MINIMIZE_VARIABLE_PROJECTION_INCLUDED_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "minimize/bootstrap.hpp"
+#include "minimize/detail/linear_algebra.hpp"
+#include "minimize/detail/normal_equations.hpp"
+#include "minimize/detail/vector_math.hpp"
+#include "minimize/fit_results.hpp"
+#include "minimize/function.hpp"
+#include "minimize/measurement.hpp"
+#include "minimize/observer.hpp"
+#include "minimize/solver_options.hpp"
+#include "minimize/wssr.hpp"
+
+namespace minimize {
+
+namespace detail {
+
+template <std::size_t NumberOfParameters>
+using parameter_mask_t = std::array<bool, NumberOfParameters>;
+
+/** Marks the parameters that the function declares as linear. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+parameter_mask_t<NumberOfParameters> linear_parameter_mask(const Function<InputDimensions, NumberOfParameters>& fun) {
+    parameter_mask_t<NumberOfParameters> rv;
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        rv[i] = fun.is_linear_parameter(i);
+    }
+    return rv;
+}
+
+/**
+ * @brief Replaces the linear parameters by their optimum for the current nonlinear parameters.
+ *
+ * The wssr is quadratic in the linear parameters, so the normal equations at par determine the optimum
+ * and the wssr there without another pass over the data:
+ * delta = N_ll^-1 * g_l and wssr(par - delta) = wssr(par) - g_l * delta,
+ * where N_ll and g_l are the rows and columns of the linear parameters in J^T W J and J^T W r.
+ *
+ * @param[in] system normal equations at par
+ * @param[in] linear mask of the linear parameters
+ * @param[in,out] par parameters, the linear ones are replaced
+ * @param[out] wssr the wssr at the new parameters
+ * @return false if the linear parameters are not determined by the data
+ */
+template <std::size_t NumberOfParameters>
+bool project_linear_parameters(const NormalEquations<NumberOfParameters>& system,
+                               const parameter_mask_t<NumberOfParameters>& linear,
+                               minimize::parameter_t<NumberOfParameters>& par, minimize::floating_t& wssr) {
+    // the nonlinear rows and columns are replaced by the identity, so the solution is 0 there
+    auto reduced = system.jtj;
+    minimize::parameter_t<NumberOfParameters> gradient;
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        for (std::size_t k = 0; k < NumberOfParameters; ++k) {
+            if (!linear[i] || !linear[k]) {
+                reduced[i][k] = i == k ? 1.0 : 0.0;
+            }
+        }
+        gradient[i] = linear[i] ? system.jtr[i] : 0.0;
+    }
+    if (!cholesky_decomposition(reduced)) {
+        return false;
+    }
+    const auto delta = cholesky_solve(reduced, gradient);
+    par = detail::axpy(-1.0, delta, par);
+    wssr = std::max(system.wssr - detail::dot(gradient, delta), minimize::floating_t{0.0});
+    return true;
+}
+
+/**
+ * @brief Computes the next nonlinear parameters with a damped Gauss-Newton step on the reduced problem.
+ *
+ * Only the nonlinear parameters are damped. The nonlinear part of the solution of the full system is the step
+ * of the reduced problem with the Kaufman approximation of its jacobian, since J^T W r vanishes for the linear
+ * parameters at their optimum. The linear parameters of next are left unchanged.
+ *
+ * @param[in] system normal equations at par
+ * @param[in] par current parameters, the linear ones are at their optimum
+ * @param[in] linear mask of the linear parameters
+ * @param[in] lambda damping factor
+ * @param[out] next the parameters after the step
+ * @return false if the damped system could not be solved
+ */
+template <std::size_t NumberOfParameters>
+bool variable_projection_step(const NormalEquations<NumberOfParameters>& system,
+                              const minimize::parameter_t<NumberOfParameters>& par,
+                              const parameter_mask_t<NumberOfParameters>& linear, minimize::floating_t lambda,
+                              minimize::parameter_t<NumberOfParameters>& next) {
+    auto damped = system.jtj;
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        if (!linear[i]) {
+            const auto diagonal = system.jtj[i][i] > 0.0 ? system.jtj[i][i] : 1.0;
+            damped[i][i] += lambda * diagonal;
+        }
+    }
+    if (!cholesky_decomposition(damped)) {
+        return false;
+    }
+    const auto delta = cholesky_solve(damped, system.jtr);
+    next = par;
+    for (std::size_t i = 0; i < NumberOfParameters; ++i) {
+        if (!linear[i]) {
+            next[i] -= delta[i];
+        }
+    }
+    return true;
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> variable_projection_impl(
+    const Function<InputDimensions, NumberOfParameters>& function, const DataVector& measurements,
+    const SolverOptions& options) {
+    FitRecorder recorder;
+    const auto tolerance = options.tolerance;
+    const auto max_iterations = options.max_iterations;
+    const minimize::floating_t lambda_scale = 10.0;
+    const minimize::floating_t min_lambda = 1e-12;
+    const minimize::floating_t max_lambda = 1e16;
+    const auto linear = linear_parameter_mask(function);
+    const bool has_nonlinear = std::find(linear.begin(), linear.end(), false) != linear.end();
+
+    auto minimum = function.parameters();
+    std::size_t iterations = 0;
+
+    auto system = compute_normal_equations(function, measurements, minimum);
+    auto wssr = system.wssr;
+
+    minimize::FitResults<NumberOfParameters> results(wssr, measurements.size());
+    results.initialize_before_fit(function);
+    record_wssr(wssr);
+    minimize::floating_t lambda = 1e-3;
+    auto rel_change = 10.0 * tolerance;
+    bool cancelled = false;
+
+    // the first iteration only eliminates the linear parameters of the start values
+    auto projected = minimum;
+    minimize::floating_t projected_wssr = wssr;
+    if (project_linear_parameters(system, linear, projected, projected_wssr) && projected_wssr < wssr) {
+        minimum = projected;
+        system = compute_normal_equations(function, measurements, minimum);
+        const auto change = 1.0 - system.wssr / wssr;
+        wssr = system.wssr;
+        record_wssr(wssr);
+        ++iterations;
+        cancelled = observer_stops_fit(options.observer, iterations, minimum, wssr, change);
+    }
+
+    while (has_nonlinear && !cancelled && iterations < max_iterations && tolerance < rel_change) {
+        if (wssr == 0.0) {
+            break;
+        }
+        minimize::parameter_t<NumberOfParameters> next_parameters;
+        minimize::floating_t next_wssr = wssr;
+        if (variable_projection_step(system, minimum, linear, lambda, next_parameters)) {
+            const auto trial = compute_normal_equations(function, measurements, next_parameters);
+            // the wssr of the projection cancels badly far away from the optimum, it is computed again
+            if (project_linear_parameters(trial, linear, next_parameters, next_wssr)) {
+                next_wssr = compute_wssr(function, measurements, next_parameters);
+            } else {
+                next_wssr = wssr;
+            }
+        }
+        if (next_wssr < wssr) {
+            minimum = next_parameters;
+            system = compute_normal_equations(function, measurements, minimum);
+            rel_change = 1.0 - next_wssr / wssr;
+            wssr = next_wssr;
+            record_wssr(wssr);
+            lambda = std::max(lambda / lambda_scale, min_lambda);
+        } else {
+            // rejected step: move towards steepest descent with a shorter step
+            lambda *= lambda_scale;
+            if (lambda > max_lambda) {
+                break;
+            }
+        }
+        ++iterations;
+        if (observer_stops_fit(options.observer, iterations, minimum, wssr, rel_change)) {
+            cancelled = true;
+        }
+    }
+
+    results.set_converged(iterations < max_iterations && !cancelled);
+    results.set_cancelled(cancelled);
+    results.set_iterations(iterations);
+    results.set_weighted_sum_of_squared_residuals(wssr);
+    results.set_optimized_values(minimum);
+    recorder.finish(results);
+    return results;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Fits a function with linear and nonlinear parameters by variable projection.
+ *
+ * The function declares its linear parameters with Function::is_linear_parameter(), e.g. the amplitude and the
+ * offset of a peak. For fixed nonlinear parameters, the optimal linear parameters follow from a small linear
+ * least squares problem, so they are eliminated after every step and only the nonlinear parameters are
+ * iterated with Levenberg-Marquardt steps. The reduced problem has fewer parameters and is usually much better
+ * conditioned, so the fit needs fewer iterations and is less sensitive to the start values of the linear
+ * parameters. A trial step needs the normal equations and the wssr at the new point, an accepted step also the
+ * normal equations there, so an iteration costs two or three passes over the data.
+ * A function without linear parameters is fitted like with levenberg_marquardt(). If all parameters are
+ * linear, the first iteration solves the problem.
+ * The line search setting of the options is not used.
+ *
+ * @param function Function to fit. The optimized parameters are stored in the function.
+ * @param measurements Measured data
+ * @param options settings of the fit
+ * @return FitResults<NumberOfParameters>
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> variable_projection(Function<InputDimensions, NumberOfParameters>& function,
+                                                             const DataVector& measurements,
+                                                             const SolverOptions& options) {
+    return minimize::bootstrap_errors<InputDimensions, NumberOfParameters, DataVector>(
+        function, measurements,
+        [&options](const Function<InputDimensions, NumberOfParameters>& f, const DataVector& data,
+                   minimize::floating_t, std::size_t) { return detail::variable_projection_impl(f, data, options); },
+        options.bootstrap, options.tolerance, options.max_iterations);
+}
+
+/** Fits a function with linear and nonlinear parameters by variable projection.
+ *
+ * @param function Function to fit. The optimized parameters are stored in the function.
+ * @param measurements Measured data
+ * @param tolerance the fit stops if the relative change of the wssr is below this value
+ * @param max_iterations iteration limit
+ * @return FitResults<NumberOfParameters>
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::FitResults<NumberOfParameters> variable_projection(Function<InputDimensions, NumberOfParameters>& function,
+                                                             const DataVector& measurements,
+                                                             minimize::floating_t tolerance = 1e-15,
+                                                             std::size_t max_iterations = 16535) {
+    SolverOptions options;
+    options.tolerance = tolerance;
+    options.max_iterations = max_iterations;
+    return variable_projection(function, measurements, options);
+}
+
+}  // namespace minimize
+
+#endif /* MINIMIZE_VARIABLE_PROJECTION_INCLUDED_HPP */
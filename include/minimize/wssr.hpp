@@ -4,23 +4,486 @@
 #ifndef MINIMIZE_WSSR_INCLUDED_HPP
 #define MINIMIZE_WSSR_INCLUDED_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <vector>
+
+#include "minimize/detail/compensated_sum.hpp"
+#include "minimize/detail/parallel_reduction.hpp"
 #include "minimize/detail/vector_math.hpp"
 #include "minimize/function.hpp"
+#include "minimize/instrumentation.hpp"
+#include "minimize/mapped_measurement_file.hpp"
 #include "minimize/measurement.hpp"
+#include "minimize/measurement_columns.hpp"
+#include "minimize/simd.hpp"
 
 namespace minimize {
 
+/** Weighted sum of squared residuals together with its gradient w.r.t. the function parameters. */
+template <std::size_t NumberOfParameters>
+struct WssrAndGradient {
+    minimize::floating_t wssr{0.0};
+    std::array<minimize::floating_t, NumberOfParameters> gradient{};
+};
+
+namespace detail {
+
+/** Number of data points passed to one call of Function::evaluate_batch. */
+constexpr std::size_t batch_size = 256;
+
+/** Number of data points passed to one call of Function::evaluate_with_gradient_batch.
+ * Smaller than batch_size for many parameters to limit the memory used by the gradients.
+ */
+constexpr std::size_t gradient_batch_size(std::size_t number_of_parameters) {
+    return number_of_parameters >= 512 ? 1 : 512 / number_of_parameters;
+}
+
+/** Returns the positions of the measurements [begin, begin + count) as contiguous array. */
+template <typename MeasurementType>
+const typename MeasurementType::input_t* gather_inputs(const std::vector<MeasurementType>& vec, std::size_t begin,
+                                                       std::size_t count,
+                                                       typename MeasurementType::input_t* buffer) {
+    for (std::size_t i = 0; i < count; ++i) {
+        buffer[i] = vec[begin + i].in;
+    }
+    return buffer;
+}
+
+template <std::size_t InputDimensions, typename Scalar>
+const typename MeasurementColumns<InputDimensions, Scalar>::input_t* gather_inputs(
+    const MeasurementColumns<InputDimensions, Scalar>& vec, std::size_t begin, std::size_t count,
+    typename MeasurementColumns<InputDimensions, Scalar>::input_t* buffer) {
+    return vec.inputs(begin, count, buffer);
+}
+
+template <std::size_t InputDimensions>
+const typename MappedMeasurementFile<InputDimensions>::input_t* gather_inputs(
+    const MappedMeasurementFile<InputDimensions>& vec, std::size_t begin, std::size_t count,
+    typename MappedMeasurementFile<InputDimensions>::input_t* buffer) {
+    for (std::size_t i = 0; i < count; ++i) {
+        buffer[i] = vec.input_at(begin + i);
+    }
+    return buffer;
+}
+
+/** Contribution of the i-th measurement with unity weight to the wssr. */
+template <std::size_t InputDimensions>
+minimize::floating_t wssr_term(const MeasurementVector<InputDimensions>& vec, std::size_t i,
+                               minimize::floating_t value) {
+    const auto diff = value - vec[i].out;
+    return diff * diff;
+}
+
+/** Contribution of the i-th measurement with error to the wssr. */
+template <std::size_t InputDimensions>
+minimize::floating_t wssr_term(const MeasurementVectorWithErrors<InputDimensions>& vec, std::size_t i,
+                               minimize::floating_t value) {
+    const auto diff = (value - vec[i].out) / vec[i].error;
+    return diff * diff;
+}
+
+/** Contribution of the i-th measurement stored in columns to the wssr. */
+template <std::size_t InputDimensions, typename Scalar>
+minimize::floating_t wssr_term(const MeasurementColumns<InputDimensions, Scalar>& vec, std::size_t i,
+                               minimize::floating_t value) {
+    const auto diff = value - vec.output(i);
+    return vec.weight(i) * diff * diff;
+}
+
+/** Contribution of the i-th measurement of a file to the wssr. Same as for measurements with errors. */
+template <std::size_t InputDimensions>
+minimize::floating_t wssr_term(const MappedMeasurementFile<InputDimensions>& vec, std::size_t i,
+                               minimize::floating_t value) {
+    const auto diff = (value - vec.output(i)) / vec.error(i);
+    return diff * diff;
+}
+
+/** Factor of the function gradient in the wssr gradient for measurements with unity weights:
+ * sum 2*(f(x)-e) * f'(x)
+ */
+template <std::size_t InputDimensions>
+minimize::floating_t gradient_factor(const MeasurementVector<InputDimensions>& vec, std::size_t i,
+                                     minimize::floating_t value) {
+    return 2.0 * (value - vec[i].out);
+}
+
+/** Factor of the function gradient in the wssr gradient for measurements with errors:
+ * sum 2*(f(x,p)-e)*f'(x,p)/error^2
+ */
+template <std::size_t InputDimensions>
+minimize::floating_t gradient_factor(const MeasurementVectorWithErrors<InputDimensions>& vec, std::size_t i,
+                                     minimize::floating_t value) {
+    const auto error = vec[i].error;
+    return 2.0 * (value - vec[i].out) / (error * error);
+}
+
+/** Factor of the function gradient in the wssr gradient for measurements stored in columns.
+ * This is the exact gradient sum 2*w*(f(x,p)-e)*f'(x,p) of the weighted wssr.
+ */
+template <std::size_t InputDimensions, typename Scalar>
+minimize::floating_t gradient_factor(const MeasurementColumns<InputDimensions, Scalar>& vec, std::size_t i,
+                                     minimize::floating_t value) {
+    return 2.0 * vec.weight(i) * (value - vec.output(i));
+}
+
+/** Factor of the function gradient in the wssr gradient for measurements in a file.
+ * Same as for measurements with errors: sum 2*(f(x,p)-e)*f'(x,p)/error^2
+ */
+template <std::size_t InputDimensions>
+minimize::floating_t gradient_factor(const MappedMeasurementFile<InputDimensions>& vec, std::size_t i,
+                                     minimize::floating_t value) {
+    const auto error = vec.error(i);
+    return 2.0 * (value - vec.output(i)) / (error * error);
+}
+
+/** Sum of the wssr terms of the measurements [first, first + count) with the function values.
+ * The terms are computed per measurement and summed with the simd kernels.
+ */
+template <typename DataVector>
+minimize::floating_t batch_wssr(const DataVector& vec, std::size_t first, std::size_t count,
+                                const minimize::floating_t* values) {
+    const auto& kernels = simd_kernels();
+    std::array<minimize::floating_t, batch_size> terms;
+    minimize::floating_t rv = 0.0;
+    for (std::size_t offset = 0; offset < count; offset += batch_size) {
+        const std::size_t n = std::min(batch_size, count - offset);
+        for (std::size_t i = 0; i < n; ++i) {
+            terms[i] = wssr_term(vec, first + offset + i, values[offset + i]);
+        }
+        rv += kernels.sum(terms.data(), n);
+    }
+    return rv;
+}
+
+/** The measured values are gathered into a contiguous array, the differences are computed by the kernel. */
+template <std::size_t InputDimensions>
+minimize::floating_t batch_wssr(const MeasurementVector<InputDimensions>& vec, std::size_t first, std::size_t count,
+                                const minimize::floating_t* values) {
+    const auto& kernels = simd_kernels();
+    std::array<minimize::floating_t, batch_size> outputs;
+    minimize::floating_t rv = 0.0;
+    for (std::size_t offset = 0; offset < count; offset += batch_size) {
+        const std::size_t n = std::min(batch_size, count - offset);
+        for (std::size_t i = 0; i < n; ++i) {
+            outputs[i] = vec[first + offset + i].out;
+        }
+        rv += kernels.sum_squared_differences(values + offset, outputs.data(), n);
+    }
+    return rv;
+}
+
+/** Columns in double precision are passed to the kernel without copies. */
+template <std::size_t InputDimensions>
+minimize::floating_t batch_wssr(const MeasurementColumns<InputDimensions, minimize::floating_t>& vec,
+                                std::size_t first, std::size_t count, const minimize::floating_t* values) {
+    return simd_kernels().sum_weighted_squared_differences(values, vec.outputs() + first, vec.weights() + first,
+                                                           count);
+}
+
+/** Computes the wssr of the measurements [begin, end). The function is evaluated in batches.
+ * The terms of a batch are summed directly, the sums of the batches are added with compensation.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+CompensatedSum compute_wssr_in_range(const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+                                     const parameter_t<NumberOfParameters>& par, std::size_t begin,
+                                     std::size_t end) {
+    using input_t = typename Function<InputDimensions, NumberOfParameters>::input_t;
+    std::array<input_t, batch_size> inputs;
+    std::array<minimize::floating_t, batch_size> values;
+    CompensatedSum rv;
+    for (std::size_t first = begin; first < end; first += batch_size) {
+        const std::size_t count = std::min(batch_size, end - first);
+        fun.evaluate_batch(gather_inputs(vec, first, count, inputs.data()), count, par, values.data());
+        rv.add(batch_wssr(vec, first, count, values.data()));
+    }
+    return rv;
+}
+
+/** Adds the wssr and its gradient of the measurements [begin, end) to rv. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+void add_wssr_and_gradient_in_range(const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+                                    const parameter_t<NumberOfParameters>& par, std::size_t begin, std::size_t end,
+                                    WssrAndGradient<NumberOfParameters>& rv) {
+    using input_t = typename Function<InputDimensions, NumberOfParameters>::input_t;
+    constexpr std::size_t block = gradient_batch_size(NumberOfParameters);
+    static_assert(sizeof(parameter_t<NumberOfParameters>) == NumberOfParameters * sizeof(minimize::floating_t),
+                  "the gradients of a batch must be contiguous");
+    const auto& kernels = simd_kernels();
+    std::array<input_t, block> inputs;
+    std::array<minimize::floating_t, block> values;
+    std::array<minimize::floating_t, block> factors;
+    std::array<parameter_t<NumberOfParameters>, block> gradients;
+    for (std::size_t first = begin; first < end; first += block) {
+        const std::size_t count = std::min(block, end - first);
+        fun.evaluate_with_gradient_batch(gather_inputs(vec, first, count, inputs.data()), count, par, values.data(),
+                                         gradients.data());
+        rv.wssr += batch_wssr(vec, first, count, values.data());
+        for (std::size_t i = 0; i < count; ++i) {
+            factors[i] = gradient_factor(vec, first + i, values[i]);
+        }
+        kernels.add_scaled_rows(rv.gradient.data(), factors.data(), gradients.data()->data(), count,
+                                NumberOfParameters);
+    }
+}
+
+/** Returns the positions of the measurements at the given indices as contiguous array. */
+template <typename MeasurementType>
+const typename MeasurementType::input_t* gather_inputs_at(const std::vector<MeasurementType>& vec,
+                                                          const std::size_t* indices, std::size_t count,
+                                                          typename MeasurementType::input_t* buffer) {
+    for (std::size_t i = 0; i < count; ++i) {
+        buffer[i] = vec[indices[i]].in;
+    }
+    return buffer;
+}
+
+template <typename DataVector>
+const typename DataVector::input_t* gather_inputs_at(const DataVector& vec, const std::size_t* indices,
+                                                     std::size_t count, typename DataVector::input_t* buffer) {
+    for (std::size_t i = 0; i < count; ++i) {
+        buffer[i] = vec.input_at(indices[i]);
+    }
+    return buffer;
+}
+
+/** Adds the wssr and its gradient of the measurements at the given indices to rv. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+void add_wssr_and_gradient_at(const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+                              const parameter_t<NumberOfParameters>& par, const std::size_t* indices,
+                              std::size_t count, WssrAndGradient<NumberOfParameters>& rv) {
+    using input_t = typename Function<InputDimensions, NumberOfParameters>::input_t;
+    constexpr std::size_t block = gradient_batch_size(NumberOfParameters);
+    std::array<input_t, block> inputs;
+    std::array<minimize::floating_t, block> values;
+    std::array<parameter_t<NumberOfParameters>, block> gradients;
+    record_gradient_evaluations(count);
+    for (std::size_t first = 0; first < count; first += block) {
+        const std::size_t n = std::min(block, count - first);
+        fun.evaluate_with_gradient_batch(gather_inputs_at(vec, indices + first, n, inputs.data()), n, par,
+                                         values.data(), gradients.data());
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t index = indices[first + i];
+            rv.wssr += wssr_term(vec, index, values[i]);
+            detail::add_to_vector(rv.gradient, gradient_factor(vec, index, values[i]), gradients[i]);
+        }
+    }
+}
+
+/** Computes the wssr of all measurements. Large data sets are reduced in parallel chunks. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::floating_t reduce_wssr(const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+                                 const parameter_t<NumberOfParameters>& par) {
+    record_evaluations(vec.size());
+    record_data_pass();
+    return reduce_in_chunks<CompensatedSum>(
+               vec.size(),
+               [&fun, &vec, &par](std::size_t begin, std::size_t end) {
+                   return compute_wssr_in_range(fun, vec, par, begin, end);
+               },
+               [](CompensatedSum& total, const CompensatedSum& partial) { total.add(partial); })
+        .value();
+}
+
+/** Computes the wssr and its gradient of all measurements. Large data sets are reduced in parallel chunks. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+WssrAndGradient<NumberOfParameters> reduce_wssr_and_gradient(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                             const DataVector& vec,
+                                                             const parameter_t<NumberOfParameters>& par) {
+    using result_t = WssrAndGradient<NumberOfParameters>;
+    record_gradient_evaluations(vec.size());
+    record_data_pass();
+    return reduce_in_chunks<result_t>(
+        vec.size(),
+        [&fun, &vec, &par](std::size_t begin, std::size_t end) {
+            result_t rv;
+            rv.gradient.fill(0.0);
+            add_wssr_and_gradient_in_range(fun, vec, par, begin, end, rv);
+            return rv;
+        },
+        [](result_t& total, const result_t& partial) {
+            total.wssr += partial.wssr;
+            detail::add_to_vector(total.gradient, 1.0, partial.gradient);
+        });
+}
+
+/** Adds the wssr of the measurements [begin, end) for every candidate to sums.
+ * The positions of a batch are gathered once and evaluated with all candidates while they are in the cache.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+void add_wssr_multi_in_range(const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+                             const parameter_t<NumberOfParameters>* candidates, std::size_t count, std::size_t begin,
+                             std::size_t end, CompensatedSum* sums) {
+    using input_t = typename Function<InputDimensions, NumberOfParameters>::input_t;
+    std::array<input_t, batch_size> inputs;
+    std::array<minimize::floating_t, batch_size> values;
+    for (std::size_t first = begin; first < end; first += batch_size) {
+        const std::size_t n = std::min(batch_size, end - first);
+        const input_t* positions = gather_inputs(vec, first, n, inputs.data());
+        for (std::size_t k = 0; k < count; ++k) {
+            fun.evaluate_batch(positions, n, candidates[k], values.data());
+            sums[k].add(batch_wssr(vec, first, n, values.data()));
+        }
+    }
+}
+
+/** Computes the wssr of all candidates in a single pass over the measurements.
+ * The chunks and batches are the same as in reduce_wssr(), so the results are identical.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+void reduce_wssr_multi(const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+                       const parameter_t<NumberOfParameters>* candidates, std::size_t count,
+                       minimize::floating_t* out) {
+    if (count == 0) {
+        return;
+    }
+    record_evaluations(count * vec.size());
+    record_data_pass();
+    const std::size_t size = vec.size();
+    const std::size_t chunks = std::max<std::size_t>(1, (size + reduction_chunk_size - 1) / reduction_chunk_size);
+    std::vector<CompensatedSum> partial(chunks * count);
+    global_thread_pool().parallel_for(chunks, [&](std::size_t chunk, std::size_t) {
+        const std::size_t begin = chunk * reduction_chunk_size;
+        add_wssr_multi_in_range(fun, vec, candidates, count, begin, std::min(size, begin + reduction_chunk_size),
+                                partial.data() + chunk * count);
+    });
+    for (std::size_t k = 0; k < count; ++k) {
+        CompensatedSum total = partial[k];
+        for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+            total.add(partial[chunk * count + k]);
+        }
+        out[k] = total.value();
+    }
+}
+
+/** Number of measurements between two checks of the partial sums by reduce_wssr_bounded(). */
+constexpr std::size_t bounded_block_size = 4 * batch_size;
+
+/** Adds x to an atomic sum and returns the new value. */
+inline minimize::floating_t atomic_add(std::atomic<minimize::floating_t>& sum, minimize::floating_t x) noexcept {
+    auto expected = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(expected, expected + x, std::memory_order_relaxed)) {
+    }
+    return expected + x;
+}
+
+/** Lowers an atomic value to at most value. */
+inline void atomic_min(std::atomic<std::size_t>& target, std::size_t value) noexcept {
+    auto expected = target.load(std::memory_order_relaxed);
+    while (value < expected && !target.compare_exchange_weak(expected, value, std::memory_order_relaxed)) {
+    }
+}
+
+/** Sets the wssr of the dropped candidates to infinity. The first computed candidates hold their wssr, the
+ * candidates after the first one above threshold are dropped, and the first one itself unless keep_first_above is set.
+ */
+inline void apply_wssr_threshold(minimize::floating_t* wssr, std::size_t computed, std::size_t count,
+                                 minimize::floating_t threshold, bool keep_first_above) noexcept {
+    for (std::size_t k = 0; k < computed; ++k) {
+        if (wssr[k] > threshold) {
+            computed = keep_first_above ? k + 1 : k;
+            break;
+        }
+    }
+    for (std::size_t k = computed; k < count; ++k) {
+        wssr[k] = std::numeric_limits<minimize::floating_t>::infinity();
+    }
+}
+
+/**
+ * @brief Computes the wssr of the candidates in a single pass, dropping the candidates that are not needed.
+ *
+ * Every chunk publishes the partial sums of its candidates after each block of bounded_block_size measurements.
+ * The terms are not negative, so once the published sum of candidate j exceeds threshold, its wssr does as well.
+ * Then the candidates after j are dropped, and j itself unless keep_first_above is set. The remaining
+ * candidates are computed in the same batches and chunks as in reduce_wssr(), so their results are identical.
+ * Dropped candidates receive infinity.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+void reduce_wssr_bounded(const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+                         const parameter_t<NumberOfParameters>* candidates, std::size_t count,
+                         minimize::floating_t threshold, bool keep_first_above, minimize::floating_t* out) {
+    using input_t = typename Function<InputDimensions, NumberOfParameters>::input_t;
+    if (count == 0) {
+        return;
+    }
+    const std::size_t size = vec.size();
+    if (size <= bounded_block_size) {
+        // too small to stop early
+        if (count == 1) {
+            out[0] = reduce_wssr(fun, vec, candidates[0]);
+        } else {
+            reduce_wssr_multi(fun, vec, candidates, count, out);
+        }
+        apply_wssr_threshold(out, count, count, threshold, keep_first_above);
+        return;
+    }
+    const std::size_t chunks = (size + reduction_chunk_size - 1) / reduction_chunk_size;
+    std::vector<CompensatedSum> partial(chunks * count);
+    std::vector<minimize::floating_t> block_sums(chunks * count, 0.0);
+    std::vector<std::atomic<minimize::floating_t>> published(count);
+    for (auto& sum : published) {
+        sum.store(0.0, std::memory_order_relaxed);
+    }
+    std::atomic<std::size_t> limit{count};
+    std::atomic<std::size_t> evaluated{0};
+    global_thread_pool().parallel_for(chunks, [&](std::size_t chunk, std::size_t) {
+        std::array<input_t, batch_size> inputs;
+        std::array<minimize::floating_t, batch_size> values;
+        CompensatedSum* sums = partial.data() + chunk * count;
+        minimize::floating_t* block = block_sums.data() + chunk * count;
+        const std::size_t begin = chunk * reduction_chunk_size;
+        const std::size_t end = std::min(size, begin + reduction_chunk_size);
+        std::size_t active = limit.load(std::memory_order_relaxed);
+        std::size_t evaluations = 0;
+        for (std::size_t block_begin = begin; block_begin < end && active > 0; block_begin += bounded_block_size) {
+            const std::size_t block_end = std::min(end, block_begin + bounded_block_size);
+            for (std::size_t first = block_begin; first < block_end; first += batch_size) {
+                const std::size_t n = std::min(batch_size, block_end - first);
+                const input_t* positions = gather_inputs(vec, first, n, inputs.data());
+                for (std::size_t k = 0; k < active; ++k) {
+                    fun.evaluate_batch(positions, n, candidates[k], values.data());
+                    const auto sum = batch_wssr(vec, first, n, values.data());
+                    sums[k].add(sum);
+                    block[k] += sum;
+                }
+                evaluations += n * active;
+            }
+            for (std::size_t k = 0; k < active; ++k) {
+                if (atomic_add(published[k], block[k]) > threshold) {
+                    atomic_min(limit, keep_first_above ? k + 1 : k);
+                }
+                block[k] = 0.0;
+            }
+            active = std::min(active, limit.load(std::memory_order_relaxed));
+        }
+        evaluated.fetch_add(evaluations, std::memory_order_relaxed);
+    });
+    record_evaluations(evaluated.load(std::memory_order_relaxed));
+    record_data_pass();
+
+    const std::size_t computed = limit.load(std::memory_order_relaxed);
+    for (std::size_t k = 0; k < computed; ++k) {
+        CompensatedSum total = partial[k];
+        for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+            total.add(partial[chunk * count + k]);
+        }
+        out[k] = total.value();
+    }
+    // the published sums are rounded differently, the decision is repeated with the exact results
+    apply_wssr_threshold(out, computed, count, threshold, keep_first_above);
+}
+
+}  // namespace detail
+
 /** Computes weighted sum of squared residuals with unity weights.  */
 template <std::size_t InputDimensions, std::size_t NumberOfParameters>
 minimize::floating_t compute_wssr(const Function<InputDimensions, NumberOfParameters>& fun,
                                   const MeasurementVector<InputDimensions>& vec,
                                   const parameter_t<NumberOfParameters>& par) {
-    minimize::floating_t rv = 0.0;
-    for (const auto& x : vec) {
-        const auto diff = (fun.evaluate(x.in, par) - x.out);
-        rv += diff * diff;
-    }
-    return rv;
+    return detail::reduce_wssr(fun, vec, par);
 }
 
 /** Computes weighted sum of squared residuals with unity weights.  */
@@ -35,12 +498,7 @@ template <std::size_t InputDimensions, std::size_t NumberOfParameters>
 minimize::floating_t compute_wssr(const Function<InputDimensions, NumberOfParameters>& fun,
                                   const MeasurementVectorWithErrors<InputDimensions>& vec,
                                   const parameter_t<NumberOfParameters>& par) {
-    minimize::floating_t rv = 0.0;
-    for (const auto& x : vec) {
-        const auto diff = (fun.evaluate(x.in, par) - x.out) / x.error;
-        rv += (diff * diff);
-    }
-    return rv;
+    return detail::reduce_wssr(fun, vec, par);
 }
 
 /** Computes weighted sum of squared residuals with weights. */
@@ -50,20 +508,116 @@ minimize::floating_t compute_wssr(const Function<InputDimensions, NumberOfParame
     return compute_wssr(fun, vec, fun.parameters());
 }
 
+/** Computes weighted sum of squared residuals of data stored in columns. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename Scalar>
+minimize::floating_t compute_wssr(const Function<InputDimensions, NumberOfParameters>& fun,
+                                  const MeasurementColumns<InputDimensions, Scalar>& vec,
+                                  const parameter_t<NumberOfParameters>& par) {
+    return detail::reduce_wssr(fun, vec, par);
+}
+
+/** Computes weighted sum of squared residuals of data stored in columns. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename Scalar>
+minimize::floating_t compute_wssr(const Function<InputDimensions, NumberOfParameters>& fun,
+                                  const MeasurementColumns<InputDimensions, Scalar>& vec) {
+    return compute_wssr(fun, vec, fun.parameters());
+}
+
+/** Computes weighted sum of squared residuals of data in a measurement file. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+minimize::floating_t compute_wssr(const Function<InputDimensions, NumberOfParameters>& fun,
+                                  const MappedMeasurementFile<InputDimensions>& vec,
+                                  const parameter_t<NumberOfParameters>& par) {
+    return detail::reduce_wssr(fun, vec, par);
+}
+
+/** Computes weighted sum of squared residuals of data in a measurement file. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+minimize::floating_t compute_wssr(const Function<InputDimensions, NumberOfParameters>& fun,
+                                  const MappedMeasurementFile<InputDimensions>& vec) {
+    return compute_wssr(fun, vec, fun.parameters());
+}
+
+/**
+ * @brief Computes the wssr of several parameter sets in a single pass over the data.
+ *
+ * Every batch of measurements is loaded once and evaluated with all candidates while it is in the cache,
+ * which is faster than one call of compute_wssr() per candidate for data sets that do not fit into the cache.
+ * The results are identical to the ones of compute_wssr().
+ *
+ * @param fun Function to evaluate
+ * @param vec Measured data
+ * @param candidates array of count parameter sets
+ * @param count number of parameter sets
+ * @param[out] out array of count values, receives the wssr of every candidate
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+void compute_wssr_multi(const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+                        const parameter_t<NumberOfParameters>* candidates, std::size_t count,
+                        minimize::floating_t* out) {
+    detail::reduce_wssr_multi(fun, vec, candidates, count, out);
+}
+
+/** Computes the wssr of several parameter sets in a single pass over the data. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+std::vector<minimize::floating_t> compute_wssr_multi(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                     const DataVector& vec,
+                                                     const std::vector<parameter_t<NumberOfParameters>>& candidates) {
+    std::vector<minimize::floating_t> rv(candidates.size());
+    detail::reduce_wssr_multi(fun, vec, candidates.data(), candidates.size(), rv.data());
+    return rv;
+}
+
+/**
+ * @brief Computes the wssr, but stops early once it is known to exceed threshold.
+ *
+ * The partial sums are checked after every block of measurements. This is useful for trial points that are
+ * rejected if their wssr is above a known value, e.g. in a line search: a rejected point usually costs only a
+ * part of a pass over the data. If the wssr is at most threshold, the result is identical to compute_wssr().
+ *
+ * @param fun Function to evaluate
+ * @param vec Measured data
+ * @param par parameters of the function
+ * @param threshold largest wssr of interest
+ * @return the wssr, or infinity if it exceeds threshold
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+minimize::floating_t compute_wssr_bounded(const Function<InputDimensions, NumberOfParameters>& fun,
+                                          const DataVector& vec, const parameter_t<NumberOfParameters>& par,
+                                          minimize::floating_t threshold) {
+    minimize::floating_t rv = 0.0;
+    detail::reduce_wssr_bounded(fun, vec, &par, 1, threshold, false, &rv);
+    return rv;
+}
+
+/**
+ * @brief Computes the wssr of several parameter sets in a single pass, up to the first one that exceeds threshold.
+ *
+ * The candidates are treated as a sequence of trial points. Once the wssr of a candidate is known to exceed
+ * threshold, the candidates after it are not needed and are dropped. The wssr of the candidates up to and
+ * including the first one above threshold is identical to compute_wssr(), the dropped candidates receive
+ * infinity.
+ *
+ * @param fun Function to evaluate
+ * @param vec Measured data
+ * @param candidates array of count parameter sets
+ * @param count number of parameter sets
+ * @param threshold the candidates after the first one with a larger wssr are dropped
+ * @param[out] out array of count values, receives the wssr of every candidate
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename DataVector>
+void compute_wssr_multi_bounded(const Function<InputDimensions, NumberOfParameters>& fun, const DataVector& vec,
+                                const parameter_t<NumberOfParameters>* candidates, std::size_t count,
+                                minimize::floating_t threshold, minimize::floating_t* out) {
+    detail::reduce_wssr_bounded(fun, vec, candidates, count, threshold, true, out);
+}
+
 /** Computes the gradient of wssr w.r.t. to the function parameters with unity weights.  */
 template <std::size_t InputDimensions, std::size_t NumberOfParameters>
 std::array<minimize::floating_t, NumberOfParameters> compute_wssr_gradient(
     const Function<InputDimensions, NumberOfParameters>& fun, const MeasurementVector<InputDimensions>& vec,
     const parameter_t<NumberOfParameters>& par) {
-    std::array<minimize::floating_t, NumberOfParameters> rv;
-    rv.fill(0.0);
-    for (const auto& x : vec) {
-        // sum 2*(f(x)-e) * f'(x)
-        const auto factor = 2.0 * (fun.evaluate(x.in, par) - x.out);
-        const auto grad = fun.parameter_gradient(x.in, par);
-        detail::add_to_vector(rv, factor, grad);
-    }
-    return rv;
+    return detail::reduce_wssr_and_gradient(fun, vec, par).gradient;
 }
 
 template <std::size_t InputDimensions, std::size_t NumberOfParameters>
@@ -77,17 +631,7 @@ template <std::size_t InputDimensions, std::size_t NumberOfParameters>
 std::array<minimize::floating_t, NumberOfParameters> compute_wssr_gradient(
     const Function<InputDimensions, NumberOfParameters>& fun, const MeasurementVectorWithErrors<InputDimensions>& vec,
     const parameter_t<NumberOfParameters>& par) {
-    std::array<minimize::floating_t, NumberOfParameters> rv;
-    rv.fill(0.0);
-    for (const auto& x : vec) {
-        // wssr: sum ((f(x,p)-e)**2)/w
-        // d/dp sum ((f(x,p)-e)**2)/w
-        // sum 2*((f(x,p)-e)* f'(x,p))/w
-        const auto factor = 2.0 * (fun.evaluate(x.in, par) - x.out) / x.error;
-        const auto grad = fun.parameter_gradient(x.in, par);
-        detail::add_to_vector(rv, factor, grad);
-    }
-    return rv;
+    return detail::reduce_wssr_and_gradient(fun, vec, par).gradient;
 }
 
 template <std::size_t InputDimensions, std::size_t NumberOfParameters>
@@ -96,6 +640,94 @@ std::array<minimize::floating_t, NumberOfParameters> compute_wssr_gradient(
     return compute_wssr_gradient(fun, vec, fun.parameters());
 }
 
+/** Computes the gradient of wssr w.r.t. to the function parameters of data stored in columns.
+ * This is the exact gradient sum 2*w*(f(x,p)-e)*f'(x,p) of the weighted wssr.
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename Scalar>
+std::array<minimize::floating_t, NumberOfParameters> compute_wssr_gradient(
+    const Function<InputDimensions, NumberOfParameters>& fun, const MeasurementColumns<InputDimensions, Scalar>& vec,
+    const parameter_t<NumberOfParameters>& par) {
+    return detail::reduce_wssr_and_gradient(fun, vec, par).gradient;
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename Scalar>
+std::array<minimize::floating_t, NumberOfParameters> compute_wssr_gradient(
+    const Function<InputDimensions, NumberOfParameters>& fun, const MeasurementColumns<InputDimensions, Scalar>& vec) {
+    return compute_wssr_gradient(fun, vec, fun.parameters());
+}
+
+/** Computes the gradient of wssr w.r.t. to the function parameters of data in a measurement file. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+std::array<minimize::floating_t, NumberOfParameters> compute_wssr_gradient(
+    const Function<InputDimensions, NumberOfParameters>& fun, const MappedMeasurementFile<InputDimensions>& vec,
+    const parameter_t<NumberOfParameters>& par) {
+    return detail::reduce_wssr_and_gradient(fun, vec, par).gradient;
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+std::array<minimize::floating_t, NumberOfParameters> compute_wssr_gradient(
+    const Function<InputDimensions, NumberOfParameters>& fun, const MappedMeasurementFile<InputDimensions>& vec) {
+    return compute_wssr_gradient(fun, vec, fun.parameters());
+}
+
+/** Computes wssr and its gradient with unity weights in a single pass over the data. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+WssrAndGradient<NumberOfParameters> compute_wssr_and_gradient(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                              const MeasurementVector<InputDimensions>& vec,
+                                                              const parameter_t<NumberOfParameters>& par) {
+    return detail::reduce_wssr_and_gradient(fun, vec, par);
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+WssrAndGradient<NumberOfParameters> compute_wssr_and_gradient(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                              const MeasurementVector<InputDimensions>& vec) {
+    return compute_wssr_and_gradient(fun, vec, fun.parameters());
+}
+
+/** Computes wssr and its gradient with weights in a single pass over the data.
+ * The gradient uses the same weighting as compute_wssr_gradient().
+ */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+WssrAndGradient<NumberOfParameters> compute_wssr_and_gradient(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                              const MeasurementVectorWithErrors<InputDimensions>& vec,
+                                                              const parameter_t<NumberOfParameters>& par) {
+    return detail::reduce_wssr_and_gradient(fun, vec, par);
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+WssrAndGradient<NumberOfParameters> compute_wssr_and_gradient(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                              const MeasurementVectorWithErrors<InputDimensions>& vec) {
+    return compute_wssr_and_gradient(fun, vec, fun.parameters());
+}
+
+/** Computes wssr and its gradient of data stored in columns in a single pass over the data. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename Scalar>
+WssrAndGradient<NumberOfParameters> compute_wssr_and_gradient(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                              const MeasurementColumns<InputDimensions, Scalar>& vec,
+                                                              const parameter_t<NumberOfParameters>& par) {
+    return detail::reduce_wssr_and_gradient(fun, vec, par);
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters, typename Scalar>
+WssrAndGradient<NumberOfParameters> compute_wssr_and_gradient(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                              const MeasurementColumns<InputDimensions, Scalar>& vec) {
+    return compute_wssr_and_gradient(fun, vec, fun.parameters());
+}
+
+/** Computes wssr and its gradient of data in a measurement file in a single pass over the data. */
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+WssrAndGradient<NumberOfParameters> compute_wssr_and_gradient(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                              const MappedMeasurementFile<InputDimensions>& vec,
+                                                              const parameter_t<NumberOfParameters>& par) {
+    return detail::reduce_wssr_and_gradient(fun, vec, par);
+}
+
+template <std::size_t InputDimensions, std::size_t NumberOfParameters>
+WssrAndGradient<NumberOfParameters> compute_wssr_and_gradient(const Function<InputDimensions, NumberOfParameters>& fun,
+                                                              const MappedMeasurementFile<InputDimensions>& vec) {
+    return compute_wssr_and_gradient(fun, vec, fun.parameters());
+}
+
 }  // namespace minimize
 
 #endif /* MINIMIZE_WSSR_INCLUDED_HPP */
@@ -0,0 +1,127 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include <cmath>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/matchers/catch_matchers_floating_point.hpp"
+#include "common.hpp"
+#include "minimize/autodiff_function.hpp"
+#include "minimize/dual.hpp"
+#include "minimize/levenberg_marquardt.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+/** The gaussian of common.hpp, written once for values and dual numbers. */
+class AutoDiffGaussian : public AutoDiffFunction<AutoDiffGaussian, 1, 2> {
+public:
+    AutoDiffGaussian() : AutoDiffFunction<AutoDiffGaussian, 1, 2>({-5, 2.0}) {}
+
+    template <typename T>
+    T model(const input_t& x, const std::array<T, 2>& parameters) const {
+        using std::exp;
+        using std::sqrt;
+        const T arg = (x - parameters[0]) / parameters[1];
+        return 1.0 / (parameters[1] * sqrt(2 * 3.14159265358979323846264338327950288419716939937510)) *
+               exp(-0.5 * arg * arg);
+    }
+};
+
+}  // namespace
+
+SCENARIO("Dual numbers compute exact derivatives", "[autodiff]") {
+    GIVEN("Two variables") {
+        const auto x = Dual<2>::variable(1.5, 0);
+        const auto y = Dual<2>::variable(-0.5, 1);
+
+        WHEN("arithmetic expressions are evaluated") {
+            const auto f = (x * y + 2.0) / (x - y) - 3.0 * x;
+            THEN("the value and the derivatives are correct") {
+                // f = (xy+2)/(x-y) - 3x
+                const double q = x.value - y.value;
+                const double p = x.value * y.value + 2.0;
+                REQUIRE(f.value == Approx(p / q - 3.0 * x.value));
+                REQUIRE(f.derivatives[0] == Approx((y.value * q - p) / (q * q) - 3.0));
+                REQUIRE(f.derivatives[1] == Approx((x.value * q + p) / (q * q)));
+            }
+        }
+
+        WHEN("math functions are evaluated") {
+            const auto f = exp(x) * sin(y) + log(x) * sqrt(x) - pow(x, 3.0) + cos(y) + atan(x) + tanh(y) + tan(y);
+            THEN("the derivatives follow the chain rule") {
+                const double a = x.value;
+                const double b = y.value;
+                REQUIRE(f.derivatives[0] == Approx(std::exp(a) * std::sin(b) + std::sqrt(a) / a +
+                                                   std::log(a) * 0.5 / std::sqrt(a) - 3.0 * a * a +
+                                                   1.0 / (1.0 + a * a)));
+                REQUIRE(f.derivatives[1] == Approx(std::exp(a) * std::cos(b) - std::sin(b) +
+                                                   (1.0 - std::tanh(b) * std::tanh(b)) +
+                                                   1.0 / (std::cos(b) * std::cos(b))));
+                REQUIRE(abs(y).derivatives[1] == -1.0);
+                REQUIRE(y < x);
+                REQUIRE(x > 1.0);
+            }
+        }
+    }
+
+    GIVEN("A variable at zero") {
+        const auto x = Dual<1>::variable(0.0, 0);
+
+        WHEN("powers are evaluated") {
+            const auto root = pow(x, 0.5);
+            const auto square = pow(x, 2.0);
+            const auto identity = pow(x, 1.0);
+            const auto constant = pow(x, 0.0);
+            THEN("the values match std::pow") {
+                REQUIRE(root.value == 0.0);
+                REQUIRE(std::isinf(root.derivatives[0]));
+                REQUIRE(square.value == 0.0);
+                REQUIRE(square.derivatives[0] == 0.0);
+                REQUIRE(identity.value == 0.0);
+                REQUIRE(identity.derivatives[0] == 1.0);
+                REQUIRE(constant.value == 1.0);
+                REQUIRE(constant.derivatives[0] == 0.0);
+            }
+        }
+    }
+}
+
+SCENARIO("Automatic differentiation of functions", "[autodiff]") {
+    GIVEN("A gaussian with automatic differentiation") {
+        AutoDiffGaussian automatic{};
+        Gaussian numerical{};
+
+        WHEN("values and gradients are computed") {
+            THEN("they match the numerical results") {
+                for (int i = -10; i <= 10; ++i) {
+                    const double x = 0.5 * i;
+                    REQUIRE(automatic.evaluate(x) == numerical.evaluate(x, numerical.parameters()));
+                    const auto exact = automatic.parameter_gradient(x);
+                    const auto approximated = numerical.parameter_gradient(x, numerical.parameters());
+                    REQUIRE(exact[0] == Approx(approximated[0]).margin(1e-9));
+                    REQUIRE(exact[1] == Approx(approximated[1]).margin(1e-9));
+                    REQUIRE(automatic.evaluate_with_gradient(x).gradient == exact);
+                }
+            }
+        }
+
+        WHEN("the function is fitted") {
+            MeasurementVector<1> vec{};
+            for (size_t i = 0; i < 50; ++i) {
+                const double x = 0.5 * i;
+                vec.emplace_back(Measurement<1>{x, compute_gaussian(x)});
+            }
+            automatic.set_parameters({12.0, 2.0});
+            const auto results = levenberg_marquardt(automatic, vec, 1e-15);
+            THEN("the parameters are found") {
+                const auto found = results.optimized_values();
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(14.0, 1e-6));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(2.5, 1e-6));
+            }
+        }
+    }
+}
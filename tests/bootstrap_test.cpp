@@ -3,12 +3,15 @@
 
 #include "minimize/bootstrap.hpp"
 
+#include <atomic>
 #include <cmath>
+#include <random>
 
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/matchers/catch_matchers_floating_point.hpp"
 #include "common.hpp"
+#include "minimize/conjugate_gradient_descent.hpp"
 
 using Catch::Approx;
 using namespace minimize;
@@ -43,3 +46,136 @@ SCENARIO("Statistics data", "[bootstrap]") {
         }
     }
 }
+
+SCENARIO("Bootstrap in parallel", "[bootstrap]") {
+    GIVEN("Noisy measurement data and multiple threads") {
+        LinearFunction linear{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            using in_t = minimize::floating_t;
+            using m_t = minimize::Measurement<1>;
+            vec.emplace_back(m_t{in_t{0.25 * i}, 1.5 * i + 27.9 + 0.1 * (i % 3)});
+        }
+        set_thread_count(4);
+
+        WHEN("the errors are estimated") {
+            const auto results = conjugate_gradient_descent(linear, vec, 1.0e-15);
+            set_thread_count(1);
+            const auto errors = results.optimized_value_errors();
+            THEN("the errors are small and positive") {
+                REQUIRE_THAT(results.optimized_values()[0], Catch::Matchers::WithinRel(6.0, 1e-4));
+                REQUIRE(errors[0] > 0.0);
+                REQUIRE(errors[0] < 0.01);
+                REQUIRE(errors[1] > 0.0);
+                REQUIRE(errors[1] < 0.1);
+            }
+        }
+    }
+}
+
+namespace {
+
+MeasurementVector<1> create_noisy_linear_data() {
+    return create_line_data(100, 0.25, 6.0, 27.9, [](std::size_t i, floating_t) { return 0.1 * (i % 3); });
+}
+
+}  // namespace
+
+SCENARIO("Bootstrap with options", "[bootstrap]") {
+    GIVEN("Noisy measurement data") {
+        const auto vec = create_noisy_linear_data();
+        std::atomic<std::size_t> fits{0};
+        minimize_function_t<1, 2, MeasurementVector<1>> minimizer =
+            [&fits](const Function<1, 2>& f, const MeasurementVector<1>& data, floating_t tolerance,
+                    std::size_t max_iterations) {
+                ++fits;
+                return detail::conjugate_gradient_descent_impl(f, data, tolerance, max_iterations);
+            };
+
+        WHEN("the errors are estimated twice with the same seed") {
+            BootstrapOptions options;
+            options.seed = 1234;
+            LinearFunction first{};
+            LinearFunction second{};
+            const auto a = bootstrap_errors(first, vec, minimizer, options);
+            set_thread_count(3);
+            const auto b = bootstrap_errors(second, vec, minimizer, options);
+            set_thread_count(1);
+            THEN("the results are identical, independent of the number of threads") {
+                REQUIRE(fits == 2 * (options.resamples + 1));
+                REQUIRE(a.optimized_value_errors()[0] == b.optimized_value_errors()[0]);
+                REQUIRE(a.optimized_value_errors()[1] == b.optimized_value_errors()[1]);
+                REQUIRE(a.optimized_value_errors()[0] > 0.0);
+            }
+        }
+
+        WHEN("the errors are estimated with different seeds") {
+            BootstrapOptions options;
+            options.seed = 1;
+            LinearFunction first{};
+            const auto a = bootstrap_errors(first, vec, minimizer, options);
+            options.seed = 2;
+            LinearFunction second{};
+            const auto b = bootstrap_errors(second, vec, minimizer, options);
+            THEN("the results differ") { REQUIRE(a.optimized_value_errors()[0] != b.optimized_value_errors()[0]); }
+        }
+
+        WHEN("the number of resamples is changed") {
+            BootstrapOptions options;
+            options.resamples = 5;
+            LinearFunction linear{};
+            const auto results = bootstrap_errors(linear, vec, minimizer, options);
+            THEN("the number of fits changes") {
+                REQUIRE(fits == 6);
+                REQUIRE(results.optimized_value_errors()[0] > 0.0);
+            }
+        }
+
+        WHEN("the early stop is enabled with a large tolerance") {
+            BasicBootstrapOptions<std::mt19937_64> options;
+            options.resamples = 64;
+            options.check_interval = 4;
+            options.stop_tolerance = 10.0;
+            LinearFunction linear{};
+            const auto results = bootstrap_errors(linear, vec, minimizer, options);
+            THEN("the estimation stops after the second check") {
+                REQUIRE(fits == 1 + 2 * options.check_interval);
+                REQUIRE(results.optimized_value_errors()[0] > 0.0);
+            }
+        }
+
+        WHEN("the early stop is enabled with more threads than the check interval") {
+            BasicBootstrapOptions<std::mt19937_64> options;
+            options.resamples = 64;
+            options.check_interval = 4;
+            options.stop_tolerance = 10.0;
+            LinearFunction linear{};
+            set_thread_count(6);
+            const auto results = bootstrap_errors(linear, vec, minimizer, options);
+            set_thread_count(1);
+            THEN("every block has one resample per thread") {
+                REQUIRE(fits == 1 + 2 * 6);
+                REQUIRE(results.optimized_value_errors()[0] > 0.0);
+            }
+        }
+    }
+
+    GIVEN("Measurement data with errors") {
+        MeasurementVectorWithErrors<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            using in_t = minimize::floating_t;
+            using m_t = minimize::MeasurementWithError<1>;
+            vec.emplace_back(m_t{in_t{0.25 * i}, 1.5 * i + 27.9 + 0.1 * (i % 3), 0.1});
+        }
+
+        WHEN("the errors are estimated") {
+            LinearFunction linear{};
+            const auto results = conjugate_gradient_descent(linear, vec, 1.0e-15);
+            THEN("the samples keep the measurement errors") {
+                REQUIRE_THAT(results.optimized_values()[0], Catch::Matchers::WithinRel(6.0, 1e-4));
+                REQUIRE(results.optimized_value_errors()[0] > 0.0);
+                REQUIRE(results.optimized_value_errors()[0] < 0.01);
+            }
+        }
+    }
+}
@@ -4,6 +4,9 @@
 #ifndef MINIMIZE_COMMON_INCLUDED_HPP
 #define MINIMIZE_COMMON_INCLUDED_HPP
 
+#include <cmath>
+#include <cstddef>
+
 #include "minimize/function.hpp"
 #include "minimize/measurement.hpp"
 
@@ -106,4 +109,23 @@ inline minimize::MeasurementVector<2> create_noisy_test_data_saddle() {
     return vec;
 }
 
+/** Measurements of the line slope * x + offset at x = step * i for i in [0, count), plus noise(i, x). */
+template <typename Noise>
+minimize::MeasurementVector<1> create_line_data(std::size_t count, minimize::floating_t step,
+                                                minimize::floating_t slope, minimize::floating_t offset,
+                                                Noise noise) {
+    minimize::MeasurementVector<1> rv{};
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto x = step * static_cast<minimize::floating_t>(i);
+        rv.push_back(minimize::Measurement<1>{x, slope * x + offset + noise(i, x)});
+    }
+    return rv;
+}
+
+/** Measurements of the line 1.5 * x - 3 at x = 0.1 * i with a small periodic deviation. */
+inline minimize::MeasurementVector<1> create_line_data(std::size_t count) {
+    return create_line_data(count, 0.1, 1.5, -3.0,
+                            [](std::size_t, minimize::floating_t x) { return 0.05 * std::sin(11.0 * x); });
+}
+
 #endif /* MINIMIZE_COMMON_INCLUDED_HPP */
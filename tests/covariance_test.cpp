@@ -0,0 +1,114 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include <cmath>
+#include <random>
+#include <string>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/matchers/catch_matchers_floating_point.hpp"
+#include "common.hpp"
+#include "minimize/minimize.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+MeasurementVector<1> create_noisy_line(std::size_t points) {
+    std::mt19937 gen{7};
+    std::normal_distribution<double> noise(0.0, 0.5);
+    return create_line_data(points, 0.1, 6.0, 28.0, [&](std::size_t, floating_t) { return noise(gen); });
+}
+
+}  // namespace
+
+SCENARIO("Parameter errors can be computed from the covariance matrix", "[covariance]") {
+    GIVEN("Noisy data of a line") {
+        const auto vec = create_noisy_line(200);
+        SolverOptions options;
+        options.bootstrap.errors = ErrorEstimation::covariance;
+
+        WHEN("the line is fitted with covariance errors") {
+            LinearFunction linear{};
+            const auto results = levenberg_marquardt(linear, vec, options);
+            THEN("the covariance is s^2 (X^T X)^-1 of the linear regression") {
+                double sx = 0.0;
+                double sxx = 0.0;
+                for (const auto& m : vec) {
+                    sx += m.in;
+                    sxx += m.in * m.in;
+                }
+                const double n = static_cast<double>(vec.size());
+                const double determinant = n * sxx - sx * sx;
+                const double s2 = results.weighted_sum_of_squared_residuals() / (n - 2.0);
+                const auto& covariance = results.covariance();
+                REQUIRE(covariance[0][0] == Approx(s2 * n / determinant).epsilon(1e-6));
+                REQUIRE(covariance[1][1] == Approx(s2 * sxx / determinant).epsilon(1e-6));
+                REQUIRE(covariance[0][1] == Approx(-s2 * sx / determinant).epsilon(1e-6));
+                REQUIRE(covariance[1][0] == covariance[0][1]);
+                REQUIRE(results.optimized_value_errors()[0] == Approx(std::sqrt(covariance[0][0])));
+                REQUIRE(results.optimized_value_errors()[1] == Approx(std::sqrt(covariance[1][1])));
+            }
+            THEN("the correlation matrix is normalized") {
+                const auto rho = results.correlation();
+                REQUIRE(rho[0][0] == Approx(1.0));
+                REQUIRE(rho[1][1] == Approx(1.0));
+                REQUIRE(rho[0][1] == rho[1][0]);
+                REQUIRE(rho[0][1] < 0.0);
+                REQUIRE(rho[0][1] > -1.0);
+                REQUIRE(results.create_report().find("Correlation matrix") != std::string::npos);
+            }
+        }
+
+        WHEN("the line is fitted with bootstrap errors") {
+            LinearFunction covariance_linear{};
+            const auto analytic = levenberg_marquardt(covariance_linear, vec, options);
+            options.bootstrap.errors = ErrorEstimation::bootstrap;
+            options.bootstrap.resamples = 64;
+            LinearFunction linear{};
+            const auto results = levenberg_marquardt(linear, vec, options);
+            THEN("the covariance of the resamples is stored and the errors agree with the analytic errors") {
+                const auto& covariance = results.covariance();
+                for (std::size_t i = 0; i < 2; ++i) {
+                    REQUIRE_THAT(results.optimized_value_errors()[i],
+                                 Catch::Matchers::WithinRel(std::sqrt(covariance[i][i]), 1e-12));
+                    REQUIRE(results.optimized_value_errors()[i] > 0.5 * analytic.optimized_value_errors()[i]);
+                    REQUIRE(results.optimized_value_errors()[i] < 2.0 * analytic.optimized_value_errors()[i]);
+                }
+                REQUIRE(results.correlation()[0][1] < 0.0);
+            }
+        }
+
+        WHEN("data in columns is fitted with a gradient solver") {
+            const MeasurementColumns<1> columns{vec};
+            LinearFunction linear{};
+            LinearFunction reference{};
+            const auto results = conjugate_gradient_descent(linear, columns, options);
+            const auto expected = levenberg_marquardt(reference, vec, options);
+            THEN("the errors match") {
+                REQUIRE(results.optimized_value_errors()[0] == Approx(expected.optimized_value_errors()[0]));
+                REQUIRE(results.optimized_value_errors()[1] == Approx(expected.optimized_value_errors()[1]));
+            }
+        }
+    }
+
+    GIVEN("Fewer measurements than parameters") {
+        MeasurementVector<1> vec{};
+        vec.push_back(Measurement<1>{1.0, 2.0});
+        SolverOptions options;
+        options.bootstrap.errors = ErrorEstimation::covariance;
+
+        WHEN("the errors are estimated") {
+            LinearFunction linear{};
+            const auto results = levenberg_marquardt(linear, vec, options);
+            THEN("no errors are reported") {
+                REQUIRE(results.optimized_value_errors()[0] == 0.0);
+                REQUIRE(results.covariance()[0][0] == 0.0);
+                REQUIRE(results.correlation()[0][1] == 0.0);
+                REQUIRE(results.create_report().find("Correlation matrix") == std::string::npos);
+            }
+        }
+    }
+}
@@ -84,6 +84,41 @@ SCENARIO("Minimum along a gradient can be found", "[line search]") {
         }
     }
 
+    GIVEN("Perfect data and the wssr at the start") {
+        SaddleFunction saddle{};
+        MeasurementVector<2> vec = create_perfect_test_data_saddle();
+        parameter_t<4> direction{-1.0, -2.0, -2.6, -10.0};
+        const auto start_wssr = compute_wssr(saddle, vec);
+
+        WHEN("an interval is searched") {
+            const auto interval = search_interval_around_minimum(saddle, saddle.parameters(), start_wssr, vec,
+                                                                 direction, 100);
+            THEN("the interval holds the wssr at both ends") {
+                REQUIRE(interval.before_wssr == compute_wssr(saddle, vec, interval.before));
+                REQUIRE(interval.past_wssr == compute_wssr(saddle, vec, interval.past));
+                REQUIRE(interval.evaluations > 0);
+            }
+            THEN("the interval is the same as without the known wssr") {
+                const auto other = search_interval_around_minimum(saddle, vec, direction, 100);
+                REQUIRE(interval.before == other.before);
+                REQUIRE(interval.past == other.past);
+                REQUIRE(other.evaluations == interval.evaluations + 1);
+            }
+        }
+
+        WHEN("the minimum is searched") {
+            const auto found = find_minimum_on_line(saddle, saddle.parameters(), start_wssr, vec, direction, 200);
+            THEN("the point, its wssr and the passes over the data are returned") {
+                REQUIRE(found.parameters == find_minimum_on_line(saddle, saddle.parameters(), vec, direction, 200));
+                REQUIRE(found.parameters[0] == Approx(0.5));
+                REQUIRE(found.parameters[3] == Approx(5.0));
+                REQUIRE(found.wssr == compute_wssr(saddle, vec, found.parameters));
+                REQUIRE(found.wssr < start_wssr);
+                REQUIRE(found.evaluations > 1);
+            }
+        }
+    }
+
     GIVEN("Noisy data") {
         SaddleFunction saddle{};
 
@@ -0,0 +1,99 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/fit_many.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/matchers/catch_matchers_floating_point.hpp"
+#include "common.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+std::vector<MeasurementVector<1>> create_datasets(std::size_t count) {
+    std::vector<MeasurementVector<1>> rv(count);
+    for (std::size_t k = 0; k < count; ++k) {
+        for (std::size_t i = 0; i < 20; ++i) {
+            const double x = 0.5 * i;
+            rv[k].emplace_back(Measurement<1>{x, 0.1 * k * x + 2.0 - 0.01 * k + 0.05 * ((i + k) % 3)});
+        }
+    }
+    return rv;
+}
+
+}  // namespace
+
+SCENARIO("Many data sets can be fitted in parallel", "[fit many]") {
+    GIVEN("A prototype and many data sets") {
+        LinearFunction prototype{};
+        prototype.set_parameters({1.0, 1.0});
+        const auto datasets = create_datasets(40);
+        SolverOptions options;
+        options.bootstrap.resamples = 4;
+
+        WHEN("the data sets are fitted with 4 threads") {
+            set_thread_count(4);
+            const auto results = fit_many(prototype, datasets, Solver::levenberg_marquardt, options);
+            set_thread_count(1);
+            THEN("every result equals the result of a single fit") {
+                REQUIRE(results.size() == datasets.size());
+                REQUIRE(prototype.parameters() == parameter_t<2>{1.0, 1.0});
+                for (std::size_t k = 0; k < datasets.size(); ++k) {
+                    LinearFunction single = prototype;
+                    const auto expected = levenberg_marquardt(single, datasets[k], options);
+                    REQUIRE(results[k].optimized_values() == expected.optimized_values());
+                    REQUIRE(results[k].optimized_value_errors() == expected.optimized_value_errors());
+                    REQUIRE(results[k].initial_values() == prototype.parameters());
+                    REQUIRE_THAT(results[k].optimized_values()[0], Catch::Matchers::WithinAbs(0.1 * k, 1e-2));
+                }
+            }
+        }
+
+        WHEN("a custom solver is used") {
+            std::size_t calls = 0;
+            const auto results = fit_many(
+                prototype, datasets.data(), 5,
+                [&calls](LinearFunction& model, const MeasurementVector<1>& data, const SolverOptions& opts) {
+                    ++calls;
+                    return conjugate_gradient_descent(model, data, opts);
+                },
+                options);
+            THEN("it is called once per data set") {
+                REQUIRE(calls == 5);
+                REQUIRE(results.size() == 5);
+                for (std::size_t k = 0; k < results.size(); ++k) {
+                    REQUIRE_THAT(results[k].optimized_values()[0], Catch::Matchers::WithinAbs(0.1 * k, 1e-2));
+                }
+            }
+        }
+
+        WHEN("all solvers are selected") {
+            options.bootstrap.resamples = 0;
+            options.line_search = LineSearch::strong_wolfe;
+            const Solver solvers[] = {Solver::steepest_descent, Solver::conjugate_gradient_descent, Solver::lbfgs,
+                                      Solver::levenberg_marquardt};
+            THEN("they find the same minimum") {
+                for (const auto solver : solvers) {
+                    const auto results = fit_many(prototype, datasets.data(), 3, solver, options);
+                    for (std::size_t k = 0; k < results.size(); ++k) {
+                        REQUIRE_THAT(results[k].optimized_values()[0], Catch::Matchers::WithinAbs(0.1 * k, 1e-2));
+                    }
+                }
+            }
+        }
+
+        WHEN("an invalid solver is selected") {
+            const auto invalid = static_cast<Solver>(100);
+            THEN("an exception is thrown") {
+                REQUIRE_THROWS_AS(fit_many(prototype, datasets.data(), 3, invalid, options), std::invalid_argument);
+            }
+        }
+    }
+}
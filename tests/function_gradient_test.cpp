@@ -101,3 +101,20 @@ SCENARIO("Gradients of gaussian", "[function]") {
         }
     }
 }
+
+SCENARIO("Value and gradient can be computed in one call", "[function]") {
+    GIVEN("A tangent function") {
+        TanFunction tan{};
+        WHEN("the value and the gradient are computed together") {
+            const double x0{40.0};
+            const auto fused = tan.evaluate_with_gradient(x0);
+            const auto gradient = tan.parameter_gradient(x0);
+            THEN("the results are identical to the separate computations") {
+                REQUIRE(fused.value == tan.evaluate(x0, tan.parameters()));
+                for (std::size_t i = 0; i < gradient.size(); ++i) {
+                    REQUIRE(fused.gradient[i] == gradient[i]);
+                }
+            }
+        }
+    }
+}
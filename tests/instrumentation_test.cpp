@@ -0,0 +1,87 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/instrumentation.hpp"
+
+#include <cstddef>
+
+#include "catch2/catch_test_macros.hpp"
+#include "common.hpp"
+#include "minimize/levenberg_marquardt.hpp"
+#include "minimize/steepest_descent.hpp"
+
+using namespace minimize;
+
+SCENARIO("Fit statistics", "[instrumentation]") {
+    GIVEN("A linear function and data") {
+        const auto data = create_line_data(200);
+
+        WHEN("the function is fitted by steepest descent with bootstrap") {
+            LinearFunction line{};
+            SolverOptions options;
+            options.line_search = LineSearch::strong_wolfe;
+            options.bootstrap.resamples = 3;
+            const auto results = steepest_descent(line, data, options);
+            const auto& statistics = results.statistics();
+            if (instrumentation_enabled) {
+                THEN("the work of the fit is recorded") {
+                    REQUIRE(statistics.data_passes() > 0);
+                    REQUIRE(statistics.gradient_evaluations() % data.size() == 0);
+                    REQUIRE(statistics.evaluations() % data.size() == 0);
+                    REQUIRE(statistics.evaluations() + statistics.gradient_evaluations() ==
+                            statistics.data_passes() * data.size());
+                    REQUIRE(statistics.line_search_passes().size() >= results.iterations());
+                    std::size_t line_search_total = 0;
+                    for (const auto passes : statistics.line_search_passes()) {
+                        line_search_total += passes;
+                    }
+                    REQUIRE(line_search_total > 0);
+                    REQUIRE(line_search_total <= statistics.data_passes());
+                    REQUIRE(statistics.fit_seconds() >= 0.0);
+                    REQUIRE(statistics.resample_seconds().size() == 3);
+                }
+                THEN("the wssr trajectory starts at the initial and ends at the final wssr") {
+                    const auto& trajectory = statistics.wssr_trajectory();
+                    REQUIRE(trajectory.size() == results.iterations() + 1);
+                    REQUIRE(trajectory.front() == results.initial_weighted_sum_of_squared_residuals());
+                    REQUIRE(trajectory.back() == results.weighted_sum_of_squared_residuals());
+                    for (std::size_t i = 1; i < trajectory.size(); ++i) {
+                        REQUIRE(trajectory[i] < trajectory[i - 1]);
+                    }
+                }
+                THEN("the report contains the statistics") {
+                    REQUIRE(results.create_report().find("Statistics:") != std::string::npos);
+                }
+            } else {
+                THEN("nothing is recorded") {
+                    REQUIRE(statistics.data_passes() == 0);
+                    REQUIRE(statistics.evaluations() == 0);
+                    REQUIRE(statistics.gradient_evaluations() == 0);
+                    REQUIRE(statistics.line_search_passes().empty());
+                    REQUIRE(statistics.wssr_trajectory().empty());
+                    REQUIRE(statistics.resample_seconds().empty());
+                    REQUIRE(results.create_report().find("Statistics:") == std::string::npos);
+                }
+            }
+        }
+
+        WHEN("the function is fitted by Levenberg-Marquardt") {
+            LinearFunction line{};
+            SolverOptions options;
+            options.bootstrap.resamples = 0;
+            const auto results = levenberg_marquardt(line, data, options);
+            const auto& statistics = results.statistics();
+            THEN("the normal equations are counted as gradient evaluations") {
+                if (instrumentation_enabled) {
+                    REQUIRE(statistics.gradient_evaluations() > 0);
+                    REQUIRE(statistics.line_search_passes().empty());
+                    REQUIRE(statistics.wssr_trajectory().front() ==
+                            results.initial_weighted_sum_of_squared_residuals());
+                    REQUIRE(statistics.wssr_trajectory().back() == results.weighted_sum_of_squared_residuals());
+                } else {
+                    REQUIRE(statistics.gradient_evaluations() == 0);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,167 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/lbfgs.hpp"
+
+#include <cmath>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/matchers/catch_matchers_floating_point.hpp"
+#include "common.hpp"
+#include "minimize/levenberg_marquardt.hpp"
+#include "minimize/linear_least_squares.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+/** Sum of 20 gaussian bumps with individual amplitudes. */
+class Bumps : public StaticFunction<Bumps, 1, 20> {
+public:
+    output_t model(const input_t& x, const parameter_t& parameters) const {
+        output_t rv = 0.0;
+        for (std::size_t i = 0; i < 20; ++i) {
+            const auto arg = x - static_cast<floating_t>(i);
+            rv += parameters[i] * std::exp(-0.5 * arg * arg);
+        }
+        return rv;
+    }
+};
+
+}  // namespace
+
+SCENARIO("L-BFGS history", "[lbfgs]") {
+    GIVEN("A history of a quadratic function with hessian diag(2, 8)") {
+        detail::LbfgsHistory<2, 2> history;
+
+        WHEN("a pair with negative curvature is added") {
+            THEN("it is rejected") {
+                REQUIRE_FALSE(history.push({1.0, 0.0}, {-2.0, 0.0}));
+                REQUIRE(history.empty());
+            }
+        }
+
+        WHEN("pairs along both axes are added") {
+            REQUIRE(history.push({1.0, 0.0}, {2.0, 0.0}));
+            REQUIRE(history.push({0.0, 1.0}, {0.0, 8.0}));
+            const auto step = history.apply({4.0, 4.0});
+            THEN("the direction is the newton step") {
+                REQUIRE(history.size() == 2);
+                REQUIRE(step[0] == Approx(2.0));
+                REQUIRE(step[1] == Approx(0.5));
+            }
+        }
+
+        WHEN("more pairs than the history size are added") {
+            REQUIRE(history.push({1.0, 0.0}, {3.0, 0.0}));
+            REQUIRE(history.push({1.0, 0.0}, {2.0, 0.0}));
+            REQUIRE(history.push({0.0, 1.0}, {0.0, 8.0}));
+            const auto step = history.apply({4.0, 4.0});
+            THEN("the oldest pair is dropped") {
+                REQUIRE(history.size() == 2);
+                REQUIRE(step[0] == Approx(2.0));
+                REQUIRE(step[1] == Approx(0.5));
+            }
+        }
+    }
+}
+
+SCENARIO("L-BFGS: fit functions", "[lbfgs]") {
+    GIVEN("Perfect measurement data of a line") {
+        LinearFunction linear{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            vec.emplace_back(Measurement<1>{0.25 * i, 4.0 * i - 3.0});
+        }
+
+        WHEN("the minimum is searched") {
+            const auto results = lbfgs(linear, vec, 1.0e-15);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(16.0, 1e-10));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(-3.0, 1e-10));
+            }
+        }
+    }
+
+    GIVEN("Perfect measurement data of a gaussian") {
+        Gaussian gauss{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            vec.emplace_back(Measurement<1>{0.25 * i, compute_gaussian(0.25 * i)});
+        }
+        gauss.set_parameters({12.0, 2.0});
+
+        WHEN("the minimum is searched with both line searches") {
+            const auto results = lbfgs(gauss, vec, 1.0e-15);
+            SolverOptions options;
+            options.line_search = LineSearch::bracketing;
+            gauss.set_parameters({12.0, 2.0});
+            const auto bracketing = lbfgs<4>(gauss, vec, options);
+            THEN("a minimum is found") {
+                REQUIRE_THAT(results.optimized_values()[0], Catch::Matchers::WithinRel(14.0, 1e-8));
+                REQUIRE_THAT(results.optimized_values()[1], Catch::Matchers::WithinRel(2.5, 1e-8));
+                REQUIRE_THAT(bracketing.optimized_values()[0], Catch::Matchers::WithinRel(14.0, 1e-6));
+                REQUIRE_THAT(bracketing.optimized_values()[1], Catch::Matchers::WithinRel(2.5, 1e-6));
+            }
+        }
+    }
+
+    GIVEN("Noisy measurement data of a gaussian with different errors") {
+        Gaussian gauss{};
+        MeasurementVectorWithErrors<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            const double error = 0.05 + 0.1 * static_cast<double>(i % 3);
+            const double noise = 0.002 * (static_cast<double>(i % 5) - 2.0);
+            vec.emplace_back(MeasurementWithError<1>{0.25 * i, compute_gaussian(0.25 * i) + noise, error});
+        }
+        gauss.set_parameters({12.0, 2.0});
+
+        WHEN("the minimum is searched with the default options") {
+            SolverOptions options;
+            options.bootstrap.resamples = 0;
+            const auto results = lbfgs(gauss, vec, options);
+            Gaussian reference{};
+            reference.set_parameters({12.0, 2.0});
+            const auto exact = levenberg_marquardt(reference, vec, options);
+            reference.set_parameters({12.0, 2.0});
+            options.line_search = LineSearch::strong_wolfe;
+            const auto wolfe = lbfgs(reference, vec, options);
+            THEN("the minimum of the weighted wssr is found with the strong Wolfe search") {
+                REQUIRE(results.converged());
+                for (std::size_t i = 0; i < 2; ++i) {
+                    REQUIRE_THAT(results.optimized_values()[i],
+                                 Catch::Matchers::WithinRel(exact.optimized_values()[i], 1e-8));
+                }
+                REQUIRE(results.iterations() == wolfe.iterations());
+                REQUIRE(results.optimized_values() == wolfe.optimized_values());
+            }
+        }
+    }
+
+    GIVEN("A model with 20 parameters") {
+        Bumps bumps{};
+        Bumps reference{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 400; ++i) {
+            const double x = 0.05 * i;
+            vec.emplace_back(Measurement<1>{x, std::sin(x) + 0.1 * x});
+        }
+
+        WHEN("the minimum is searched") {
+            SolverOptions options;
+            options.line_search = LineSearch::strong_wolfe;
+            options.tolerance = 1e-14;
+            options.bootstrap.resamples = 0;
+            const auto results = lbfgs(bumps, vec, options);
+            const auto exact = linear_least_squares(reference, vec);
+            THEN("the wssr of the least squares solution is reached") {
+                REQUIRE(results.weighted_sum_of_squared_residuals() ==
+                        Approx(exact.weighted_sum_of_squared_residuals()).epsilon(1e-4));
+                REQUIRE(results.iterations() < 500);
+            }
+        }
+    }
+}
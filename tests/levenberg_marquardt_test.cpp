@@ -0,0 +1,144 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/levenberg_marquardt.hpp"
+
+#include <cmath>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/matchers/catch_matchers_floating_point.hpp"
+#include "common.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+SCENARIO("Cholesky decomposition", "[levenberg marquardt]") {
+    GIVEN("A symmetric positive definite matrix") {
+        matrix_t<3> a{{{{4.0, 12.0, -16.0}}, {{12.0, 37.0, -43.0}}, {{-16.0, -43.0, 98.0}}}};
+        WHEN("the linear system is solved") {
+            auto l = a;
+            const bool ok = detail::cholesky_decomposition(l);
+            const auto x = detail::cholesky_solve(l, parameter_t<3>{-20.0, -43.0, 192.0});
+            THEN("the correct solution is found") {
+                REQUIRE(ok);
+                REQUIRE(l[0][0] == Approx(2.0));
+                REQUIRE(l[1][0] == Approx(6.0));
+                REQUIRE(l[2][2] == Approx(3.0));
+                REQUIRE(x[0] == Approx(1.0));
+                REQUIRE(x[1] == Approx(2.0));
+                REQUIRE(x[2] == Approx(3.0));
+            }
+        }
+    }
+
+    GIVEN("A singular matrix") {
+        matrix_t<2> a{{{{1.0, 1.0}}, {{1.0, 1.0}}}};
+        WHEN("the decomposition is computed") {
+            THEN("it fails") { REQUIRE_FALSE(detail::cholesky_decomposition(a)); }
+        }
+    }
+}
+
+SCENARIO("Levenberg-Marquardt: fit linear function", "[levenberg marquardt]") {
+    GIVEN("Perfect measurement data") {
+        LinearFunction linear{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            using in_t = minimize::floating_t;
+            using m_t = minimize::Measurement<1>;
+            vec.emplace_back(m_t{in_t{0.25 * i}, 4.0 * i - 3.0});
+        }
+
+        WHEN("the minimum is searched") {
+            const auto results = levenberg_marquardt(linear, vec, 1.0e-15);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE(results.converged());
+                REQUIRE_THAT(results.weighted_sum_of_squared_residuals(), Catch::Matchers::WithinAbs(0.0, 1e-18));
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(16.0, 1e-14));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(-3.0, 1e-12));
+            }
+        }
+    }
+
+    GIVEN("Noisy measurement data") {
+        LinearFunction linear{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            using in_t = minimize::floating_t;
+            using m_t = minimize::Measurement<1>;
+            vec.emplace_back(m_t{in_t{0.25 * i}, 1.5 * i + 27.9 + 0.1 * (i % 3)});
+        }
+
+        WHEN("the minimum is searched") {
+            const auto results = levenberg_marquardt(linear, vec, 1.0e-15);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(6.0, 1e-4));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(28.0, 1e-4));
+                REQUIRE_THAT(results.weighted_sum_of_squared_residuals(), Catch::Matchers::WithinAbs(0.67, 1e-2));
+            }
+        }
+    }
+
+    GIVEN("Noisy measurement data with errors") {
+        LinearFunction linear{};
+        MeasurementVectorWithErrors<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            using in_t = minimize::floating_t;
+            using m_t = minimize::MeasurementWithError<1>;
+            vec.emplace_back(m_t{in_t{0.25 * i}, 1.5 * i + 27.9 + 0.1 * (i % 3), 0.1});
+        }
+
+        WHEN("the minimum is searched") {
+            const auto results = detail::levenberg_marquardt_impl(linear, vec, 1.0e-15);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(6.0, 1e-4));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(28.0, 1e-4));
+                REQUIRE_THAT(results.weighted_sum_of_squared_residuals(), Catch::Matchers::WithinAbs(67.0, 1.0));
+            }
+        }
+    }
+}
+
+SCENARIO("Levenberg-Marquardt: gaussian function", "[levenberg marquardt]") {
+    GIVEN("Perfect measurement data") {
+        Gaussian gauss{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            using in_t = minimize::floating_t;
+            using m_t = minimize::Measurement<1>;
+            vec.emplace_back(m_t{in_t{0.25 * i}, compute_gaussian(0.25 * i)});
+        }
+        gauss.set_parameters(::minimize::parameter_t<2>{0.0, 1.0});
+
+        WHEN("the minimum is searched") {
+            const auto results = levenberg_marquardt(gauss, vec, 1.0e-15);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(14.0, 1e-8));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(2.5, 1e-8));
+                REQUIRE_THAT(results.weighted_sum_of_squared_residuals(), Catch::Matchers::WithinAbs(0.0, 1e-8));
+            }
+        }
+    }
+}
+
+SCENARIO("Levenberg-Marquardt: fit saddle function", "[levenberg marquardt]") {
+    GIVEN("Perfect measurement data") {
+        SaddleFunction saddle{};
+        // measurements for 0.5, 1.0, 1.3, 5.0
+        MeasurementVector<2> vec = create_perfect_test_data_saddle();
+
+        WHEN("the minimum is searched") {
+            const auto results = levenberg_marquardt(saddle, vec, 1.0e-9);
+            THEN("a minimum is found") {
+                // there are infinitely many solutions
+                // => check that results converged.
+                REQUIRE_THAT(results.weighted_sum_of_squared_residuals(), Catch::Matchers::WithinAbs(0.0, 1e-18));
+            }
+        }
+    }
+}
@@ -0,0 +1,180 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/line_search.hpp"
+
+#include <cmath>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/matchers/catch_matchers_floating_point.hpp"
+#include "common.hpp"
+#include "minimize/conjugate_gradient_descent.hpp"
+#include "minimize/steepest_descent.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+/** Gaussian that counts the passes over the data that compute the gradient. */
+class CountingGaussian : public Gaussian {
+public:
+    virtual void evaluate_with_gradient_batch(const input_t* x, std::size_t count, const parameter_t& parameters,
+                                              output_t* values, parameter_t* gradients) const {
+        if (x == first_input) {
+            ++passes;
+        }
+        Gaussian::evaluate_with_gradient_batch(x, count, parameters, values, gradients);
+    }
+
+    mutable const input_t* first_input{nullptr};
+    mutable std::size_t passes{0};
+};
+
+MeasurementVector<1> create_gaussian_data() {
+    MeasurementVector<1> vec{};
+    for (size_t i = 0; i < 100; ++i) {
+        vec.emplace_back(Measurement<1>{0.25 * i, compute_gaussian(0.25 * i)});
+    }
+    return vec;
+}
+
+}  // namespace
+
+SCENARIO("Strong Wolfe line search", "[line search]") {
+    GIVEN("A saddle function and perfect data") {
+        SaddleFunction saddle{};
+        MeasurementVector<2> vec = create_perfect_test_data_saddle();
+        const auto start = compute_wssr_and_gradient(saddle, vec);
+
+        WHEN("a step along the gradient is searched") {
+            LineSearchState state;
+            const auto rv = strong_wolfe_line_search(saddle, vec, saddle.parameters(), start, start.gradient, state);
+            THEN("the strong Wolfe conditions hold at the accepted point") {
+                const auto slope0 = -detail::dot(start.gradient, start.gradient);
+                const auto slope = -detail::dot(rv.value.gradient, start.gradient);
+                REQUIRE(rv.converged);
+                REQUIRE(rv.step > 0.0);
+                REQUIRE(rv.value.wssr <= start.wssr + 1e-4 * rv.step * slope0);
+                REQUIRE(std::abs(slope) <= 0.1 * std::abs(slope0));
+                REQUIRE(rv.value.wssr == Approx(compute_wssr(saddle, vec, rv.parameters)));
+                REQUIRE(rv.evaluations <= 6);
+                REQUIRE(state.step == rv.step);
+            }
+        }
+
+        WHEN("the direction does not descend") {
+            LineSearchState state;
+            const auto rv = strong_wolfe_line_search(saddle, vec, saddle.parameters(), start,
+                                                     detail::scale_vector(-1.0, start.gradient), state);
+            THEN("the start point is returned without evaluations") {
+                REQUIRE_FALSE(rv.converged);
+                REQUIRE(rv.evaluations == 0);
+                REQUIRE(rv.parameters == saddle.parameters());
+                REQUIRE(state.step == 0.0);
+            }
+        }
+    }
+}
+
+SCENARIO("Solvers with strong Wolfe line search", "[line search]") {
+    SolverOptions options;
+    options.line_search = LineSearch::strong_wolfe;
+    options.tolerance = 1e-15;
+    options.bootstrap.resamples = 0;
+
+    GIVEN("Perfect measurement data of a line") {
+        LinearFunction linear{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            vec.emplace_back(Measurement<1>{0.25 * i, 4.0 * i - 3.0});
+        }
+
+        WHEN("the minimum is searched with conjugate gradients") {
+            const auto results = conjugate_gradient_descent(linear, vec, options);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(16.0, 1e-8));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(-3.0, 1e-8));
+            }
+        }
+
+        WHEN("the minimum is searched with steepest descent") {
+            const auto results = steepest_descent(linear, vec, options);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(16.0, 1e-6));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(-3.0, 1e-4));
+            }
+        }
+    }
+
+    GIVEN("Perfect measurement data of a gaussian") {
+        const auto vec = create_gaussian_data();
+        CountingGaussian gauss{};
+        gauss.first_input = &vec[0].in;
+        gauss.set_parameters({12.0, 2.0});
+
+        WHEN("the minimum is searched with conjugate gradients") {
+            const auto results = conjugate_gradient_descent(gauss, vec, options);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found with few passes over the data") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(14.0, 1e-6));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(2.5, 1e-6));
+                REQUIRE(results.iterations() > 0);
+                REQUIRE(gauss.passes <= 8 * results.iterations() + 1);
+            }
+        }
+    }
+
+    GIVEN("Noisy measurement data of a saddle function") {
+        SaddleFunction saddle{};
+        MeasurementVector<2> vec = create_noisy_test_data_saddle();
+        SaddleFunction reference{};
+        SolverOptions bracketing = options;
+        bracketing.line_search = LineSearch::bracketing;
+
+        WHEN("the minimum is searched with both line searches") {
+            const auto results = conjugate_gradient_descent(saddle, vec, options);
+            const auto expected = conjugate_gradient_descent(reference, vec, bracketing);
+            THEN("the same minimum is found") {
+                REQUIRE(results.weighted_sum_of_squared_residuals() ==
+                        Approx(expected.weighted_sum_of_squared_residuals()).epsilon(1e-6));
+            }
+        }
+    }
+    GIVEN("A saddle function and the bracketing line search") {
+        SaddleFunction saddle{};
+        MeasurementVector<2> vec = create_perfect_test_data_saddle();
+        const auto start = compute_wssr_and_gradient(saddle, vec);
+
+        WHEN("a step along the gradient is searched") {
+            LineSearchState state;
+            const auto rv = detail::line_search(saddle, vec, saddle.parameters(), start, start.gradient,
+                                                LineSearch::bracketing, state);
+            THEN("the accepted point is returned with its wssr, gradient and passes over the data") {
+                REQUIRE(rv.converged);
+                REQUIRE(rv.value.wssr < start.wssr);
+                REQUIRE(rv.value.wssr == Approx(compute_wssr(saddle, vec, rv.parameters)));
+                const auto gradient = compute_wssr_gradient(saddle, vec, rv.parameters);
+                for (std::size_t i = 0; i < gradient.size(); ++i) {
+                    REQUIRE(rv.value.gradient[i] == Approx(gradient[i]));
+                }
+                REQUIRE(rv.evaluations > 1);
+            }
+        }
+
+        WHEN("the direction does not descend") {
+            LineSearchState state;
+            const auto rv = detail::line_search(saddle, vec, saddle.parameters(), start,
+                                                detail::scale_vector(-1.0, start.gradient), LineSearch::bracketing,
+                                                state);
+            THEN("the start point is returned without computing the gradient") {
+                REQUIRE_FALSE(rv.converged);
+                REQUIRE(rv.parameters == saddle.parameters());
+                REQUIRE(rv.value.wssr == start.wssr);
+            }
+        }
+    }
+}
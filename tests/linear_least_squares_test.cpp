@@ -0,0 +1,80 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include <cmath>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/matchers/catch_matchers_floating_point.hpp"
+#include "common.hpp"
+#include "minimize/linear_least_squares.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+SCENARIO("Linear least squares: fit polynomials in closed form", "[linear least squares]") {
+    GIVEN("Perfect measurement data of a cubic polynomial") {
+        Polynomial<3> poly{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            const double x = 0.1 * i - 5.0;
+            vec.emplace_back(Measurement<1>{x, 0.5 * x * x * x - 2.0 * x * x + 3.0 * x - 7.0});
+        }
+
+        WHEN("the minimum is searched") {
+            const auto results = linear_least_squares(poly, vec);
+            const auto found = results.optimized_values();
+            THEN("the exact solution is found in a single step") {
+                REQUIRE(results.converged());
+                REQUIRE(results.iterations() == 1);
+                REQUIRE_THAT(results.weighted_sum_of_squared_residuals(), Catch::Matchers::WithinAbs(0.0, 1e-18));
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(-7.0, 1e-12));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(3.0, 1e-12));
+                REQUIRE_THAT(found[2], Catch::Matchers::WithinRel(-2.0, 1e-12));
+                REQUIRE_THAT(found[3], Catch::Matchers::WithinRel(0.5, 1e-12));
+                REQUIRE(poly.parameters() == found);
+            }
+        }
+    }
+
+    GIVEN("Noisy weighted measurement data of a line") {
+        Polynomial<1> poly{};
+        LinearFunction linear{};
+        MeasurementVectorWithErrors<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            vec.emplace_back(
+                MeasurementWithError<1>{0.25 * i, 1.5 * i + 27.9 + 0.1 * (i % 3), 0.5 + 0.01 * (i % 7)});
+        }
+
+        WHEN("the minimum is searched") {
+            const auto results = linear_least_squares(poly, vec);
+            const auto reference = linear_least_squares(linear, vec);
+            THEN("the minimum of the wssr is found") {
+                const auto found = results.optimized_values();
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(28.0, 1e-4));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(6.0, 1e-4));
+                REQUIRE(results.weighted_sum_of_squared_residuals() ==
+                        Approx(reference.weighted_sum_of_squared_residuals()));
+                auto shifted = found;
+                shifted[1] += 1e-6;
+                REQUIRE(compute_wssr(poly, vec, shifted) > results.weighted_sum_of_squared_residuals());
+            }
+        }
+    }
+
+    GIVEN("Fewer distinct positions than parameters") {
+        Polynomial<2> poly{{1.0, 1.0, 1.0}};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 10; ++i) {
+            vec.emplace_back(Measurement<1>{i % 2 == 0 ? 1.0 : 2.0, 5.0});
+        }
+
+        WHEN("the minimum is searched") {
+            const auto results = detail::linear_least_squares_impl(poly, vec);
+            THEN("the fit is reported as not converged") {
+                REQUIRE_FALSE(results.converged());
+                REQUIRE(results.optimized_values() == poly.parameters());
+            }
+        }
+    }
+}
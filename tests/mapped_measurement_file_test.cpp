@@ -0,0 +1,140 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/mapped_measurement_file.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "common.hpp"
+#include "minimize/levenberg_marquardt.hpp"
+#include "minimize/measurement_columns.hpp"
+#include "minimize/wssr.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+/** Removes the file when the test ends. */
+struct TemporaryFile {
+    explicit TemporaryFile(std::string p) : path(std::move(p)) {}
+    ~TemporaryFile() { std::remove(path.c_str()); }
+    std::string path;
+};
+
+MeasurementVectorWithErrors<2> create_saddle_data_with_errors() {
+    MeasurementVectorWithErrors<2> rv;
+    std::size_t i = 0;
+    for (const auto& x : create_noisy_test_data_saddle()) {
+        rv.push_back(MeasurementWithError<2>{x.in, x.out, 0.5 + 0.1 * (i % 4)});
+        ++i;
+    }
+    return rv;
+}
+
+}  // namespace
+
+SCENARIO("Measurement files can be mapped", "[mapped file]") {
+    GIVEN("A measurement file") {
+        TemporaryFile file{"minimize_mapped_measurement_test.bin"};
+        const auto data = create_saddle_data_with_errors();
+        write_measurement_file(file.path, data);
+
+        WHEN("the file is mapped") {
+            const MappedMeasurementFile<2> mapped{file.path};
+            THEN("the records match the written data") {
+                REQUIRE(mapped.size() == data.size());
+                REQUIRE_FALSE(mapped.empty());
+                for (std::size_t i = 0; i < data.size(); ++i) {
+                    REQUIRE(mapped.records()[i].in == data[i].in);
+                    REQUIRE(mapped[i].out == data[i].out);
+                    REQUIRE(mapped.error(i) == data[i].error);
+                }
+            }
+        }
+
+        WHEN("the wssr and the gradient are computed") {
+            const MappedMeasurementFile<2> mapped{file.path};
+            SaddleFunction saddle{};
+            saddle.set_parameters({0.4, 1.1, 1.2, 4.0});
+            const auto both = compute_wssr_and_gradient(saddle, mapped);
+            const auto expected = compute_wssr_and_gradient(saddle, data);
+            THEN("the results match the data in memory") {
+                REQUIRE(compute_wssr(saddle, mapped) == expected.wssr);
+                REQUIRE(both.wssr == expected.wssr);
+                REQUIRE(both.gradient == expected.gradient);
+                REQUIRE(compute_wssr_gradient(saddle, mapped) == expected.gradient);
+            }
+            THEN("the gradient matches the same data in columns") {
+                const MeasurementColumns<2> columns{data};
+                const auto reference = compute_wssr_gradient(saddle, columns);
+                for (std::size_t k = 0; k < 4; ++k) {
+                    REQUIRE(both.gradient[k] == Approx(reference[k]));
+                }
+            }
+        }
+
+        WHEN("a function is fitted with bootstrap errors") {
+            const MappedMeasurementFile<2> mapped{file.path};
+            SaddleFunction saddle{};
+            SaddleFunction reference{};
+            SolverOptions options;
+            options.tolerance = 1e-12;
+            options.bootstrap.errors = ErrorEstimation::bootstrap;
+            const auto results = levenberg_marquardt(saddle, mapped, options);
+            const auto expected = levenberg_marquardt(reference, data, options);
+            THEN("the results match the data in memory and the file is unchanged") {
+                REQUIRE(results.optimized_values() == expected.optimized_values());
+                REQUIRE(results.optimized_value_errors() == expected.optimized_value_errors());
+                for (std::size_t i = 0; i < data.size(); ++i) {
+                    REQUIRE(mapped[i].out == data[i].out);
+                }
+            }
+        }
+
+        WHEN("a function is fitted with the default options") {
+            const MappedMeasurementFile<2> mapped{file.path};
+            SaddleFunction saddle{};
+            SaddleFunction reference{};
+            const auto results = levenberg_marquardt(saddle, mapped, 1e-12);
+            SolverOptions options;
+            options.tolerance = 1e-12;
+            options.bootstrap.errors = ErrorEstimation::covariance;
+            const auto expected = levenberg_marquardt(reference, data, options);
+            THEN("the errors are estimated from the covariance") {
+                REQUIRE(results.optimized_values() == expected.optimized_values());
+                for (std::size_t i = 0; i < 4; ++i) {
+                    REQUIRE(results.optimized_value_errors()[i] == Approx(expected.optimized_value_errors()[i]));
+                }
+            }
+        }
+
+        WHEN("the file is mapped with the wrong number of dimensions") {
+            THEN("an exception is thrown") {
+                REQUIRE_THROWS_AS(MappedMeasurementFile<1>{file.path}, std::runtime_error);
+            }
+        }
+    }
+
+    GIVEN("Files that are not measurement files") {
+        TemporaryFile file{"minimize_invalid_measurement_test.bin"};
+        {
+            std::ofstream out(file.path, std::ios::binary);
+            out << "This is not a measurement file, but it is long enough for a header.";
+        }
+
+        WHEN("the files are mapped") {
+            THEN("exceptions are thrown") {
+                REQUIRE_THROWS_AS(MappedMeasurementFile<2>{file.path}, std::runtime_error);
+                REQUIRE_THROWS_AS(MappedMeasurementFile<2>{"minimize_missing_measurement_file.bin"},
+                                  std::runtime_error);
+            }
+        }
+    }
+}
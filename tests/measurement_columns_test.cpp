@@ -0,0 +1,193 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/measurement_columns.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/matchers/catch_matchers_floating_point.hpp"
+#include "common.hpp"
+#include "minimize/minimize.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+bool is_aligned(const void* p) { return reinterpret_cast<std::uintptr_t>(p) % detail::cache_line_size == 0; }
+
+}  // namespace
+
+SCENARIO("Measurements can be stored in columns", "[columns]") {
+    GIVEN("Measured data of a saddle function") {
+        const auto vec = create_noisy_test_data_saddle();
+
+        WHEN("the data is converted to columns") {
+            const MeasurementColumns<2> columns{vec};
+            THEN("all values are stored in aligned arrays") {
+                REQUIRE(columns.size() == vec.size());
+                REQUIRE(is_aligned(columns.input(0)));
+                REQUIRE(is_aligned(columns.input(1)));
+                REQUIRE(is_aligned(columns.outputs()));
+                REQUIRE(is_aligned(columns.weights()));
+                for (std::size_t i = 0; i < vec.size(); ++i) {
+                    REQUIRE(columns.input(0)[i] == vec[i].in[0]);
+                    REQUIRE(columns.input(1)[i] == vec[i].in[1]);
+                    REQUIRE(columns.output(i) == vec[i].out);
+                    REQUIRE(columns.weight(i) == 1.0);
+                }
+            }
+        }
+
+        WHEN("the wssr is computed") {
+            SaddleFunction saddle{};
+            const MeasurementColumns<2> columns{vec};
+            const auto expected_gradient = compute_wssr_gradient(saddle, vec);
+            const auto gradient = compute_wssr_gradient(saddle, columns);
+            const auto both = compute_wssr_and_gradient(saddle, columns);
+            THEN("the results are identical to the ones of the vector") {
+                REQUIRE(compute_wssr(saddle, columns) == Approx(compute_wssr(saddle, vec)));
+                REQUIRE(both.wssr == Approx(compute_wssr(saddle, vec)));
+                for (std::size_t i = 0; i < 4; ++i) {
+                    REQUIRE(gradient[i] == Approx(expected_gradient[i]));
+                    REQUIRE(both.gradient[i] == Approx(expected_gradient[i]));
+                }
+            }
+        }
+    }
+
+    GIVEN("Measured data with errors") {
+        LinearFunction linear{};
+        MeasurementVectorWithErrors<1> vec{};
+        for (size_t i = 0; i < 10; ++i) {
+            double in{static_cast<double>(i)};
+            vec.push_back(MeasurementWithError<1>{in, linear.evaluate(in) + 0.5, 0.5});
+        }
+
+        WHEN("the data is converted to columns") {
+            const MeasurementColumns<1> columns{vec};
+            THEN("the weights are the inverse variances") {
+                REQUIRE(columns.weight(0) == 4.0);
+                REQUIRE(compute_wssr(linear, columns) == Approx(10.0));
+                REQUIRE(compute_wssr(linear, columns) == Approx(compute_wssr(linear, vec)));
+            }
+        }
+
+        WHEN("the gradient is computed") {
+            const MeasurementColumns<1> columns{vec};
+            const auto gradient = compute_wssr_gradient(linear, columns);
+            THEN("it is the exact gradient of the weighted wssr") {
+                // 2 * 4 * (-0.5) * sum(x) and 2 * 4 * (-0.5) * 10
+                REQUIRE(gradient[0] == Approx(-180.0));
+                REQUIRE(gradient[1] == Approx(-40.0));
+            }
+        }
+    }
+}
+
+SCENARIO("Measurements can be stored in single precision columns", "[columns]") {
+    GIVEN("Measured data of a saddle function") {
+        const auto vec = create_noisy_test_data_saddle();
+
+        WHEN("the data is converted to float columns") {
+            const MeasurementColumns<2, float> columns{vec};
+            THEN("the values are rounded to float") {
+                REQUIRE(columns.size() == vec.size());
+                REQUIRE(is_aligned(columns.input(0)));
+                REQUIRE(is_aligned(columns.outputs()));
+                for (std::size_t i = 0; i < vec.size(); ++i) {
+                    REQUIRE(columns.input(0)[i] == static_cast<float>(vec[i].in[0]));
+                    REQUIRE(columns.input(1)[i] == static_cast<float>(vec[i].in[1]));
+                    REQUIRE(columns.output(i) == static_cast<double>(static_cast<float>(vec[i].out)));
+                    REQUIRE(columns.weight(i) == 1.0);
+                }
+            }
+        }
+
+        WHEN("the wssr is computed") {
+            SaddleFunction saddle{};
+            const MeasurementColumns<2, float> columns{vec};
+            const auto expected_gradient = compute_wssr_gradient(saddle, vec);
+            const auto both = compute_wssr_and_gradient(saddle, columns);
+            THEN("the results match the double precision results to float precision") {
+                REQUIRE(compute_wssr(saddle, columns) == Approx(compute_wssr(saddle, vec)).epsilon(1e-5));
+                REQUIRE(both.wssr == Approx(compute_wssr(saddle, vec)).epsilon(1e-5));
+                for (std::size_t i = 0; i < 4; ++i) {
+                    REQUIRE(both.gradient[i] == Approx(expected_gradient[i]).epsilon(1e-4));
+                }
+            }
+        }
+    }
+
+    GIVEN("Noisy one dimensional data in float columns") {
+        MeasurementColumns<1, float> columns{};
+        for (size_t i = 0; i < 1000; ++i) {
+            columns.push_back(0.025 * i, 1.5 * 0.1 * i + 27.9 + 0.1 * (i % 3));
+        }
+
+        WHEN("the positions are read in a batch") {
+            std::array<double, 4> buffer{};
+            const auto* positions = columns.inputs(2, 4, buffer.data());
+            THEN("they are converted to double") {
+                REQUIRE(positions == buffer.data());
+                REQUIRE(positions[0] == static_cast<double>(static_cast<float>(0.05)));
+            }
+        }
+
+        WHEN("the minimum is searched with Levenberg-Marquardt") {
+            LinearFunction linear{};
+            const auto results = levenberg_marquardt(linear, columns, 1.0e-12);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(6.0, 1e-4));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(28.0, 1e-4));
+                REQUIRE(results.optimized_value_errors()[0] > 0.0);
+            }
+        }
+    }
+}
+
+SCENARIO("Solvers accept measurements stored in columns", "[columns]") {
+    GIVEN("Noisy measurement data") {
+        MeasurementColumns<1> columns{};
+        for (size_t i = 0; i < 100; ++i) {
+            columns.push_back(0.25 * i, 1.5 * i + 27.9 + 0.1 * (i % 3));
+        }
+
+        WHEN("the minimum is searched with conjugate gradients") {
+            LinearFunction linear{};
+            const auto results = conjugate_gradient_descent(linear, columns, 1.0e-15);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(6.0, 1e-4));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(28.0, 1e-4));
+                REQUIRE_THAT(results.weighted_sum_of_squared_residuals(), Catch::Matchers::WithinAbs(0.67, 1e-2));
+                REQUIRE(results.optimized_value_errors()[0] > 0.0);
+            }
+        }
+
+        WHEN("the minimum is searched with steepest descent") {
+            LinearFunction linear{};
+            const auto results = steepest_descent(linear, columns, 1.0e-15);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(6.0, 1e-4));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(28.0, 1e-4));
+            }
+        }
+
+        WHEN("the minimum is searched with Levenberg-Marquardt") {
+            LinearFunction linear{};
+            const auto results = levenberg_marquardt(linear, columns, 1.0e-15);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(6.0, 1e-4));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(28.0, 1e-4));
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/observer.hpp"
+
+#include <cstddef>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "common.hpp"
+#include "minimize/fit_many.hpp"
+#include "minimize/linear_least_squares.hpp"
+
+using namespace minimize;
+
+SCENARIO("Observing fits", "[observer]") {
+    GIVEN("A linear function and data") {
+        const auto data = create_line_data(100);
+
+        WHEN("steepest descent is observed") {
+            LinearFunction line{};
+            std::vector<FitProgress> calls;
+            std::vector<floating_t> wssrs;
+            SolverOptions options;
+            options.bootstrap.resamples = 4;
+            options.observer = [&calls, &wssrs](const FitProgress& progress) {
+                calls.push_back(progress);
+                wssrs.push_back(progress.wssr);
+                return ObserverAction::proceed;
+            };
+            const auto results = steepest_descent(line, data, options);
+            THEN("the observer is called after every iteration of the main fit") {
+                REQUIRE_FALSE(results.cancelled());
+                REQUIRE(calls.size() == results.iterations());
+                for (std::size_t i = 0; i < calls.size(); ++i) {
+                    REQUIRE(calls[i].iteration == i + 1);
+                    REQUIRE(calls[i].number_of_parameters == 2);
+                    REQUIRE(calls[i].relative_change > 0.0);
+                }
+                for (std::size_t i = 1; i < wssrs.size(); ++i) {
+                    REQUIRE(wssrs[i] < wssrs[i - 1]);
+                }
+                REQUIRE(wssrs.back() == results.weighted_sum_of_squared_residuals());
+            }
+        }
+
+        WHEN("the observer stops steepest descent after three iterations") {
+            LinearFunction line{};
+            SolverOptions options;
+            options.bootstrap.resamples = 4;
+            options.observer = [](const FitProgress& progress) {
+                return progress.iteration == 3 ? ObserverAction::stop : ObserverAction::proceed;
+            };
+            const auto results = steepest_descent(line, data, options);
+            THEN("the fit is cancelled without bootstrap") {
+                REQUIRE(results.cancelled());
+                REQUIRE_FALSE(results.converged());
+                REQUIRE(results.iterations() == 3);
+                REQUIRE(results.optimized_value_errors()[0] == 0.0);
+                REQUIRE(results.weighted_sum_of_squared_residuals() <
+                        results.initial_weighted_sum_of_squared_residuals());
+                REQUIRE(line.parameters() == results.optimized_values());
+            }
+        }
+
+        WHEN("every solver is stopped after the first iteration") {
+            const std::vector<Solver> solvers{Solver::steepest_descent, Solver::conjugate_gradient_descent,
+                                              Solver::lbfgs, Solver::levenberg_marquardt,
+                                              Solver::stochastic_gradient_descent};
+            SolverOptions options;
+            options.bootstrap.resamples = 0;
+            options.stochastic.evaluation_interval = 10;
+            THEN("all fits are cancelled after one iteration") {
+                for (const auto solver : solvers) {
+                    LinearFunction line{};
+                    std::size_t calls = 0;
+                    options.observer = [&calls](const FitProgress&) {
+                        ++calls;
+                        return ObserverAction::stop;
+                    };
+                    const auto results = detail::run_solver(solver, line, data, options);
+                    REQUIRE(results.cancelled());
+                    REQUIRE(calls == 1);
+                }
+                LinearFunction line{};
+                const auto results = linear_least_squares(line, data, options);
+                REQUIRE(results.cancelled());
+            }
+        }
+
+        WHEN("the bootstrap is stopped after four resamples") {
+            LinearFunction line{};
+            SolverOptions options;
+            options.bootstrap.resamples = 64;
+            std::vector<FitProgress> calls;
+            options.bootstrap.observer = [&calls](const FitProgress& progress) {
+                calls.push_back(progress);
+                return progress.iteration >= 4 ? ObserverAction::stop : ObserverAction::proceed;
+            };
+            const auto results = levenberg_marquardt(line, data, options);
+            THEN("the errors are computed from the finished resamples") {
+                REQUIRE(results.cancelled());
+                REQUIRE(calls.size() >= 4);
+                REQUIRE(calls.size() < 64);
+                for (const auto& progress : calls) {
+                    REQUIRE(progress.number_of_parameters == 2);
+                    REQUIRE(progress.parameters != nullptr);
+                }
+                REQUIRE(results.optimized_value_errors()[0] > 0.0);
+                REQUIRE(std::isfinite(results.optimized_value_errors()[1]));
+            }
+        }
+    }
+}
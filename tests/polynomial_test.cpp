@@ -8,6 +8,21 @@
 #include "catch2/matchers/catch_matchers_floating_point.hpp"
 #include "minimize/function.hpp"
 
+namespace {
+
+/** Polynomials can be extended by overriding their virtual methods. */
+class ShiftedPolynomial : public minimize::Polynomial<1> {
+public:
+    using minimize::Polynomial<1>::Polynomial;
+
+    virtual output_t evaluate(const input_t& x, const parameter_t& parameters) const {
+        return minimize::Polynomial<1>::evaluate(x - 1.0, parameters);
+    }
+    using minimize::Polynomial<1>::evaluate;
+};
+
+}  // namespace
+
 SCENARIO("Polynomials", "[function]") {
     GIVEN("A polynomial of first degree") {
         minimize::Polynomial<1> poly{{-2.0, 3.0}};
@@ -40,4 +55,45 @@ SCENARIO("Polynomials", "[function]") {
             }
         }
     }
+
+    GIVEN("A polynomial of third degree") {
+        minimize::Polynomial<3> poly{{-2.0, 3.0, 1.0, 0.5}};
+
+        WHEN("the gradient is computed") {
+            const auto gradient = poly.parameter_gradient(2.0);
+            const auto both = poly.evaluate_with_gradient(2.0);
+            THEN("it is the exact power series") {
+                REQUIRE(gradient[0] == 1.0);
+                REQUIRE(gradient[1] == 2.0);
+                REQUIRE(gradient[2] == 4.0);
+                REQUIRE(gradient[3] == 8.0);
+                REQUIRE(both.gradient == gradient);
+                REQUIRE(both.value == poly.evaluate(2.0));
+                REQUIRE(both.value == 12.0);
+            }
+        }
+    }
+
+    GIVEN("A static polynomial of third degree") {
+        minimize::Polynomial<3> poly{{-2.0, 3.0, 1.0, 0.5}};
+        minimize::StaticPolynomial<3> fast{{-2.0, 3.0, 1.0, 0.5}};
+
+        WHEN("values and gradients are computed") {
+            const auto both = fast.evaluate_with_gradient(2.0);
+            THEN("they match the polynomial") {
+                REQUIRE(fast.evaluate(-1.5) == poly.evaluate(-1.5));
+                REQUIRE(both.value == 12.0);
+                REQUIRE(both.gradient == poly.parameter_gradient(2.0));
+                REQUIRE(fast.is_linear_parameter(3));
+            }
+        }
+    }
+
+    GIVEN("A class derived from a polynomial") {
+        ShiftedPolynomial poly{{-2.0, 3.0}};
+
+        WHEN("a value is computed") {
+            THEN("the overridden method is used") { REQUIRE(poly.evaluate(1.0) == -2.0); }
+        }
+    }
 }
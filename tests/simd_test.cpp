@@ -0,0 +1,137 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/simd.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "common.hpp"
+#include "minimize/wssr.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+const SimdLevel all_levels[] = {SimdLevel::scalar, SimdLevel::sse2, SimdLevel::avx2, SimdLevel::avx512};
+
+bool is_supported(SimdLevel level) {
+    return static_cast<int>(level) <= static_cast<int>(detail::supported_simd_level());
+}
+
+std::vector<floating_t> create_values(std::size_t n, floating_t scale) {
+    std::vector<floating_t> rv(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        rv[i] = scale * std::sin(0.37 * static_cast<double>(i) + scale) + 1e-3 * static_cast<double>(i);
+    }
+    return rv;
+}
+
+}  // namespace
+
+SCENARIO("All simd levels compute bit identical reductions", "[simd]") {
+    GIVEN("Arrays with lengths that are not multiples of the vector width") {
+        const auto values = create_values(1003, 2.0);
+        const auto outputs = create_values(1003, 1.5);
+        const auto weights = create_values(1003, 0.25);
+        const auto& scalar = detail::simd_kernels(SimdLevel::scalar);
+
+        WHEN("the kernels of every supported level are called") {
+            THEN("the results equal the scalar kernels") {
+                for (const auto level : all_levels) {
+                    if (!is_supported(level)) {
+                        continue;
+                    }
+                    const auto& kernels = detail::simd_kernels(level);
+                    for (const std::size_t n : {0u, 1u, 7u, 8u, 9u, 15u, 16u, 17u, 255u, 1003u}) {
+                        REQUIRE(kernels.sum(values.data(), n) == scalar.sum(values.data(), n));
+                        REQUIRE(kernels.sum_squared_differences(values.data(), outputs.data(), n) ==
+                                scalar.sum_squared_differences(values.data(), outputs.data(), n));
+                        REQUIRE(kernels.sum_weighted_squared_differences(values.data(), outputs.data(),
+                                                                         weights.data(), n) ==
+                                scalar.sum_weighted_squared_differences(values.data(), outputs.data(),
+                                                                        weights.data(), n));
+                    }
+                }
+            }
+        }
+
+        WHEN("scaled rows are added") {
+            THEN("the results equal the scalar kernel for every number of columns") {
+                for (const auto level : all_levels) {
+                    if (!is_supported(level)) {
+                        continue;
+                    }
+                    const auto& kernels = detail::simd_kernels(level);
+                    for (std::size_t columns = 1; columns <= 19; ++columns) {
+                        const std::size_t count = values.size() / columns;
+                        std::vector<floating_t> expected(columns, 0.5);
+                        std::vector<floating_t> out(columns, 0.5);
+                        scalar.add_scaled_rows(expected.data(), weights.data(), values.data(), count, columns);
+                        kernels.add_scaled_rows(out.data(), weights.data(), values.data(), count, columns);
+                        REQUIRE(out == expected);
+                    }
+                }
+            }
+        }
+
+        WHEN("the sum is computed") {
+            THEN("it matches the plain sum") {
+                floating_t expected = 0.0;
+                for (const auto x : values) {
+                    expected += x;
+                }
+                REQUIRE(detail::simd_kernels().sum(values.data(), values.size()) == Approx(expected));
+            }
+        }
+    }
+}
+
+SCENARIO("The simd level of the wssr can be selected", "[simd]") {
+    GIVEN("Weighted measurements in columns and in a vector") {
+        Gaussian gauss{};
+        MeasurementVectorWithErrors<1> vec{};
+        for (std::size_t i = 0; i < 5000; ++i) {
+            const double in{-10.0 + 4e-3 * static_cast<double>(i)};
+            vec.push_back(MeasurementWithError<1>{in, compute_gaussian(in), 0.1 + 1e-4 * static_cast<double>(i)});
+        }
+        const MeasurementColumns<1> columns{vec};
+        const auto supported = detail::supported_simd_level();
+
+        WHEN("a level wider than supported is requested") {
+            const auto selected = set_simd_level(SimdLevel::avx512);
+            THEN("the supported level is selected") {
+                REQUIRE(selected == supported);
+                REQUIRE(simd_level() == supported);
+            }
+        }
+
+        WHEN("the wssr is computed with every supported level") {
+            set_simd_level(SimdLevel::scalar);
+            REQUIRE(simd_level() == SimdLevel::scalar);
+            const auto expected_columns = compute_wssr_and_gradient(gauss, columns);
+            const auto expected_vector = compute_wssr_and_gradient(gauss, vec);
+            THEN("the results are identical") {
+                for (const auto level : all_levels) {
+                    if (!is_supported(level)) {
+                        continue;
+                    }
+                    set_simd_level(level);
+                    REQUIRE(compute_wssr(gauss, columns) == compute_wssr(gauss, columns, gauss.parameters()));
+                    const auto both_columns = compute_wssr_and_gradient(gauss, columns);
+                    const auto both_vector = compute_wssr_and_gradient(gauss, vec);
+                    REQUIRE(both_columns.wssr == expected_columns.wssr);
+                    REQUIRE(both_columns.gradient == expected_columns.gradient);
+                    REQUIRE(both_vector.wssr == expected_vector.wssr);
+                    REQUIRE(both_vector.gradient == expected_vector.gradient);
+                }
+                set_simd_level(supported);
+                REQUIRE(compute_wssr(gauss, columns) == Approx(compute_wssr(gauss, vec)));
+            }
+        }
+    }
+}
@@ -0,0 +1,117 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include <cmath>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/matchers/catch_matchers_floating_point.hpp"
+#include "common.hpp"
+#include "minimize/conjugate_gradient_descent.hpp"
+#include "minimize/function.hpp"
+#include "minimize/steepest_descent.hpp"
+#include "minimize/wssr.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+/** Same model as SaddleFunction, but resolved at compile time. */
+class StaticSaddle : public StaticFunction<StaticSaddle, 2, 4> {
+public:
+    StaticSaddle() : StaticFunction<StaticSaddle, 2, 4>({0.25, 0.5, 0.65, 2.5}) {}
+
+    output_t model(const input_t& x, const parameter_t& parameters) const {
+        return parameters[0] * x[0] * x[0] + parameters[1] * x[1] * x[1] + parameters[2] * x[0] * x[1] + parameters[3];
+    }
+};
+
+/** Linear model with an analytic gradient that counts the calls. */
+class StaticLinear : public StaticFunction<StaticLinear, 1, 2> {
+public:
+    StaticLinear() : StaticFunction<StaticLinear, 1, 2>({2.0, 42.0}) {}
+
+    output_t model(const input_t& x, const parameter_t& parameters) const { return parameters[0] * x + parameters[1]; }
+
+    ValueAndGradient<2> model_with_gradient(const input_t& x, const parameter_t& parameters) const {
+        ++analytic_gradients;
+        ValueAndGradient<2> rv;
+        rv.value = model(x, parameters);
+        rv.gradient = {x, 1.0};
+        return rv;
+    }
+
+    mutable std::size_t analytic_gradients{0};
+};
+
+}  // namespace
+
+SCENARIO("Static functions behave like virtual functions", "[function]") {
+    GIVEN("A model as static and as virtual function") {
+        StaticSaddle fast{};
+        SaddleFunction slow{};
+        const auto vec = create_noisy_test_data_saddle();
+
+        WHEN("values and gradients are computed") {
+            THEN("the results are the same") {
+                for (const auto& x : vec) {
+                    REQUIRE(fast.evaluate(x.in) == slow.evaluate(x.in));
+                    const auto fast_gradient = fast.parameter_gradient(x.in);
+                    const auto slow_gradient = slow.parameter_gradient(x.in);
+                    for (std::size_t i = 0; i < 4; ++i) {
+                        REQUIRE(fast_gradient[i] == Approx(slow_gradient[i]));
+                    }
+                }
+                REQUIRE(compute_wssr(fast, vec) == Approx(compute_wssr(slow, vec)));
+                const auto fast_wssr_gradient = compute_wssr_gradient(fast, vec);
+                const auto slow_wssr_gradient = compute_wssr_gradient(slow, vec);
+                for (std::size_t i = 0; i < 4; ++i) {
+                    REQUIRE(fast_wssr_gradient[i] == Approx(slow_wssr_gradient[i]));
+                }
+            }
+        }
+
+        WHEN("both are fitted") {
+            fast.set_parameters({1.0, 1.0, 1.0, 1.0});
+            slow.set_parameters({1.0, 1.0, 1.0, 1.0});
+            const auto fast_results = conjugate_gradient_descent(fast, vec, 1.0e-12);
+            const auto slow_results = conjugate_gradient_descent(slow, vec, 1.0e-12);
+            THEN("the same minimum is found") {
+                const auto found = fast_results.optimized_values();
+                const auto expected = slow_results.optimized_values();
+                for (std::size_t i = 0; i < 4; ++i) {
+                    REQUIRE_THAT(found[i], Catch::Matchers::WithinRel(expected[i], 1e-6));
+                }
+            }
+        }
+    }
+
+    GIVEN("A static function with an analytic gradient") {
+        StaticLinear linear{};
+        const Function<1, 2>& base = linear;
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            vec.emplace_back(Measurement<1>{0.25 * i, 4.0 * i - 3.0});
+        }
+
+        WHEN("the gradient is computed through the base class") {
+            const auto gradient = base.parameter_gradient(2.0);
+            THEN("the analytic gradient is used") {
+                REQUIRE(linear.analytic_gradients == 1);
+                REQUIRE(gradient[0] == 2.0);
+                REQUIRE(gradient[1] == 1.0);
+            }
+        }
+
+        WHEN("the minimum is searched") {
+            const auto results = steepest_descent(linear, vec, 1.0e-15);
+            const auto found = results.optimized_values();
+            THEN("a minimum is found") {
+                REQUIRE(linear.analytic_gradients > 0);
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(16.0, 1e-6));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(-3.0, 1e-4));
+            }
+        }
+    }
+}
@@ -0,0 +1,178 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/stochastic_gradient_descent.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "common.hpp"
+#include "minimize/levenberg_marquardt.hpp"
+#include "minimize/measurement_columns.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+MeasurementVector<1> create_noisy_line(std::size_t count) {
+    return create_line_data(count, 10.0 / static_cast<floating_t>(count), 3.0, 1.0,
+                            [](std::size_t, floating_t x) { return 0.1 * std::sin(17.0 * x); });
+}
+
+SolverOptions create_options(StochasticUpdate update) {
+    SolverOptions options;
+    options.max_iterations = 20000;
+    options.bootstrap.resamples = 0;
+    options.stochastic.update = update;
+    options.stochastic.batch_size = 256;
+    options.stochastic.evaluation_interval = 500;
+    return options;
+}
+
+}  // namespace
+
+SCENARIO("Gradients of mini-batches", "[stochastic gradient descent]") {
+    GIVEN("Measurements stored in columns") {
+        const MeasurementColumns<2> data{create_noisy_test_data_saddle()};
+        SaddleFunction saddle{};
+
+        WHEN("the gradient of a batch with all indices is computed") {
+            std::vector<std::size_t> indices(data.size());
+            std::iota(indices.begin(), indices.end(), std::size_t{0});
+            WssrAndGradient<4> batch;
+            detail::add_wssr_and_gradient_at(saddle, data, saddle.parameters(), indices.data(), indices.size(), batch);
+            const auto expected = compute_wssr_and_gradient(saddle, data);
+            THEN("it is the gradient of all measurements") {
+                REQUIRE(batch.wssr == Approx(expected.wssr));
+                for (std::size_t i = 0; i < 4; ++i) {
+                    REQUIRE(batch.gradient[i] == Approx(expected.gradient[i]));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Epoch permutations of the measurements", "[stochastic gradient descent]") {
+    GIVEN("Permutations of different sizes") {
+        std::mt19937_64 generator{42};
+
+        WHEN("several epochs are generated") {
+            THEN("every epoch visits every index once") {
+                for (const std::size_t size : {1, 2, 7, 12, 1000}) {
+                    detail::EpochPermutation order(size);
+                    for (int epoch = 0; epoch < 3; ++epoch) {
+                        order.shuffle(generator);
+                        std::vector<int> visits(size, 0);
+                        bool in_range = true;
+                        for (std::size_t i = 0; i < size; ++i) {
+                            const auto index = order.next();
+                            in_range = in_range && index < size;
+                            if (index < size) {
+                                ++visits[index];
+                            }
+                        }
+                        REQUIRE(in_range);
+                        REQUIRE(std::count(visits.begin(), visits.end(), 1) == static_cast<std::ptrdiff_t>(size));
+                    }
+                }
+            }
+        }
+
+        WHEN("the first batch of a large permutation is drawn") {
+            const std::size_t size = 1000000;
+            detail::EpochPermutation order(size);
+            order.shuffle(generator);
+            std::vector<std::size_t> batch(1024);
+            for (auto& index : batch) {
+                index = order.next();
+            }
+            std::vector<std::size_t> differences(batch.size() - 1);
+            for (std::size_t i = 0; i + 1 < batch.size(); ++i) {
+                differences[i] = (batch[i + 1] + size - batch[i]) % size;
+            }
+            std::sort(differences.begin(), differences.end());
+            std::vector<int> deciles(10, 0);
+            for (const auto index : batch) {
+                ++deciles[index / (size / 10)];
+            }
+            THEN("the batch is spread over the data and not an arithmetic progression") {
+                REQUIRE(differences.front() != differences.back());
+                for (const auto count : deciles) {
+                    REQUIRE(count > 60);
+                    REQUIRE(count < 150);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Fitting with stochastic gradient descent", "[stochastic gradient descent]") {
+    GIVEN("A large noisy data set of a line") {
+        const auto data = create_noisy_line(20000);
+        LinearFunction reference{};
+        levenberg_marquardt(reference, data, SolverOptions{});
+
+        WHEN("the line is fitted with Adam") {
+            LinearFunction line{};
+            auto options = create_options(StochasticUpdate::adam);
+            options.stochastic.learning_rate = 0.05;
+            options.stochastic.decay = 1e-3;
+            const auto results = stochastic_gradient_descent(line, data, options);
+            THEN("the parameters are close to the least squares solution") {
+                REQUIRE(results.weighted_sum_of_squared_residuals() <
+                        results.initial_weighted_sum_of_squared_residuals());
+                REQUIRE(results.iterations() > 0);
+                REQUIRE(line.parameters()[0] == Approx(reference.parameters()[0]).epsilon(1e-2));
+                REQUIRE(line.parameters()[1] == Approx(reference.parameters()[1]).epsilon(1e-2));
+            }
+        }
+
+        WHEN("the line is fitted with momentum") {
+            LinearFunction line{};
+            auto options = create_options(StochasticUpdate::momentum);
+            options.stochastic.learning_rate = 1e-3;
+            const auto results = stochastic_gradient_descent(line, data, options);
+            THEN("the parameters are close to the least squares solution") {
+                REQUIRE(results.weighted_sum_of_squared_residuals() <
+                        results.initial_weighted_sum_of_squared_residuals());
+                REQUIRE(line.parameters()[0] == Approx(reference.parameters()[0]).epsilon(1e-2));
+                REQUIRE(line.parameters()[1] == Approx(reference.parameters()[1]).epsilon(1e-2));
+            }
+        }
+
+        WHEN("the learning rate is too large") {
+            LinearFunction line{};
+            auto options = create_options(StochasticUpdate::momentum);
+            options.stochastic.learning_rate = 1.0;
+            options.stochastic.evaluation_interval = 10;
+            options.stochastic.patience = 3;
+            const auto results = stochastic_gradient_descent(line, data, options);
+            THEN("the fit stops after patience checks without improvement and does not converge") {
+                REQUIRE_FALSE(results.converged());
+                REQUIRE(results.iterations() == 30);
+                REQUIRE(results.weighted_sum_of_squared_residuals() ==
+                        results.initial_weighted_sum_of_squared_residuals());
+            }
+        }
+
+        WHEN("the line is fitted twice with the same seed") {
+            LinearFunction first{};
+            LinearFunction second{};
+            auto options = create_options(StochasticUpdate::adam);
+            options.max_iterations = 1000;
+            const auto a = stochastic_gradient_descent(first, data, options);
+            const auto b = stochastic_gradient_descent(second, data, options);
+            THEN("the results are identical") {
+                REQUIRE(a.optimized_values() == b.optimized_values());
+                REQUIRE(a.iterations() == b.iterations());
+            }
+        }
+    }
+}
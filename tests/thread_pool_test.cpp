@@ -0,0 +1,93 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/thread_pool.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+
+using namespace minimize;
+
+SCENARIO("Thread pool executes loops", "[thread pool]") {
+    GIVEN("A pool with 4 threads") {
+        ThreadPool pool{4};
+
+        WHEN("a loop is executed") {
+            std::vector<std::atomic<int>> calls(1000);
+            std::atomic<bool> valid_workers{true};
+            pool.parallel_for(calls.size(), [&](std::size_t i, std::size_t worker) {
+                ++calls[i];
+                if (worker >= pool.size()) {
+                    valid_workers = false;
+                }
+            });
+            THEN("every index is visited exactly once") {
+                REQUIRE(pool.size() == 4);
+                REQUIRE(valid_workers);
+                for (const auto& c : calls) {
+                    REQUIRE(c == 1);
+                }
+            }
+        }
+
+        WHEN("loops are nested") {
+            std::atomic<int> calls{0};
+            pool.parallel_for(8, [&](std::size_t, std::size_t) {
+                pool.parallel_for(8, [&](std::size_t, std::size_t worker) {
+                    if (worker == 0) {
+                        ++calls;
+                    }
+                });
+            });
+            THEN("the inner loops run serially") { REQUIRE(calls == 64); }
+        }
+
+        WHEN("a loop has fewer indices than threads") {
+            std::atomic<bool> valid_workers{true};
+            for (int repeat = 0; repeat < 100; ++repeat) {
+                pool.parallel_for(2, [&](std::size_t, std::size_t worker) {
+                    if (worker >= 2) {
+                        valid_workers = false;
+                    }
+                });
+            }
+            std::atomic<std::size_t> nested{0};
+            pool.parallel_for(4, [&](std::size_t, std::size_t) { nested = pool.concurrency(100); });
+            THEN("only as many workers as indices are used") {
+                REQUIRE(pool.concurrency(2) == 2);
+                REQUIRE(pool.concurrency(100) == 4);
+                REQUIRE(pool.concurrency(0) == 1);
+                REQUIRE(valid_workers);
+                REQUIRE(nested == 1);
+            }
+        }
+
+        WHEN("a task throws") {
+            THEN("the exception is passed to the caller") {
+                REQUIRE_THROWS_AS(pool.parallel_for(100,
+                                                    [](std::size_t i, std::size_t) {
+                                                        if (i == 42) {
+                                                            throw std::runtime_error("failure");
+                                                        }
+                                                    }),
+                                  std::runtime_error);
+            }
+        }
+    }
+
+    GIVEN("The library thread pool") {
+        WHEN("the thread count is changed") {
+            set_thread_count(3);
+            const auto changed = thread_count();
+            set_thread_count(0);
+            const auto reset = thread_count();
+            THEN("the pool is resized") {
+                REQUIRE(changed == 3);
+                REQUIRE(reset == 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,153 @@
+// Copyright (C) 2023 by domohuhn
+// SPDX-License-Identifier: Zlib
+
+#include "minimize/variable_projection.hpp"
+
+#include <cmath>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/matchers/catch_matchers_floating_point.hpp"
+#include "common.hpp"
+#include "minimize/levenberg_marquardt.hpp"
+#include "minimize/linear_least_squares.hpp"
+
+using Catch::Approx;
+using namespace minimize;
+
+namespace {
+
+/** Gaussian peak with the linear parameters amplitude and offset: p2 * exp(-0.5 * ((x - p0) / p1)^2) + p3. */
+class Peak : public Function<1, 4> {
+public:
+    Peak() : Function<1, 4>({3.0, 1.5, 120.0, 10.0}) {}
+
+    virtual output_t evaluate(const input_t& x, const parameter_t& parameters) const {
+        const auto arg = (x - parameters[0]) / parameters[1];
+        return parameters[2] * std::exp(-0.5 * arg * arg) + parameters[3];
+    }
+    using Function<1, 4>::evaluate;
+
+    virtual ValueAndGradient<4> evaluate_with_gradient(const input_t& x, const parameter_t& parameters) const {
+        const auto arg = (x - parameters[0]) / parameters[1];
+        const auto shape = std::exp(-0.5 * arg * arg);
+        const auto scaled = parameters[2] * shape;
+        ValueAndGradient<4> rv;
+        rv.value = scaled + parameters[3];
+        rv.gradient = {scaled * arg / parameters[1], scaled * arg * arg / parameters[1], shape, 1.0};
+        return rv;
+    }
+    using Function<1, 4>::evaluate_with_gradient;
+
+    virtual bool is_linear_parameter(std::size_t i) const { return i >= 2; }
+};
+
+MeasurementVector<1> create_peak_data(floating_t noise) {
+    const Peak peak{};
+    MeasurementVector<1> vec{};
+    for (size_t i = 0; i < 200; ++i) {
+        const floating_t x = -10.0 + 0.1 * static_cast<floating_t>(i);
+        const floating_t sign = i % 2 == 0 ? 1.0 : -1.0;
+        vec.emplace_back(Measurement<1>{x, peak.evaluate(x) + sign * noise * static_cast<floating_t>(i % 5)});
+    }
+    return vec;
+}
+
+}  // namespace
+
+SCENARIO("Variable projection: fit a peak with linear amplitude and offset", "[variable projection]") {
+    GIVEN("Perfect measurement data and start values far from the linear parameters") {
+        const auto vec = create_peak_data(0.0);
+        Peak peak{};
+        peak.set_parameters({1.5, 1.0, 1.0, 0.0});
+        SolverOptions options;
+        options.bootstrap.resamples = 0;
+        options.tolerance = 1e-12;
+
+        WHEN("the peak is fitted") {
+            const auto results = variable_projection(peak, vec, options);
+            const auto found = results.optimized_values();
+            THEN("the parameters are found") {
+                REQUIRE(results.converged());
+                REQUIRE_THAT(results.weighted_sum_of_squared_residuals(), Catch::Matchers::WithinAbs(0.0, 1e-12));
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(3.0, 1e-8));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(1.5, 1e-8));
+                REQUIRE_THAT(found[2], Catch::Matchers::WithinRel(120.0, 1e-8));
+                REQUIRE_THAT(found[3], Catch::Matchers::WithinRel(10.0, 1e-8));
+                REQUIRE(peak.parameters() == found);
+            }
+            THEN("it needs fewer iterations than Levenberg-Marquardt on all parameters") {
+                Peak other{};
+                other.set_parameters({1.5, 1.0, 1.0, 0.0});
+                const auto reference = levenberg_marquardt(other, vec, options);
+                REQUIRE(results.iterations() < reference.iterations());
+            }
+        }
+    }
+
+    GIVEN("Noisy measurement data") {
+        const auto vec = create_peak_data(0.5);
+        Peak peak{};
+        peak.set_parameters({0.0, 1.0, 1.0, 0.0});
+
+        WHEN("the peak is fitted") {
+            const auto results = variable_projection(peak, vec, 1e-12);
+            const auto found = results.optimized_values();
+            THEN("the minimum is found") {
+                REQUIRE(results.converged());
+                REQUIRE(results.weighted_sum_of_squared_residuals() ==
+                        Approx(compute_wssr(peak, vec, found)).epsilon(1e-12));
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(3.0, 1e-2));
+                REQUIRE_THAT(found[2], Catch::Matchers::WithinRel(120.0, 1e-2));
+            }
+            THEN("the linear parameters are optimal for the nonlinear ones") {
+                const auto gradient = compute_wssr_gradient(peak, vec, found);
+                const auto scale = compute_wssr(peak, vec, found);
+                REQUIRE(std::abs(gradient[2]) < 1e-6 * scale);
+                REQUIRE(std::abs(gradient[3]) < 1e-6 * scale);
+            }
+        }
+    }
+}
+
+SCENARIO("Variable projection: special cases", "[variable projection]") {
+    GIVEN("A polynomial, all parameters are linear") {
+        Polynomial<2> polynomial{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 20; ++i) {
+            const floating_t x = 0.5 * static_cast<floating_t>(i);
+            vec.emplace_back(Measurement<1>{x, 2.0 - 3.0 * x + 0.5 * x * x + 0.01 * static_cast<floating_t>(i % 3)});
+        }
+
+        WHEN("the polynomial is fitted") {
+            const auto results = variable_projection(polynomial, vec);
+            Polynomial<2> other{};
+            const auto reference = linear_least_squares(other, vec);
+            THEN("the first iteration solves the problem") {
+                REQUIRE(results.converged());
+                REQUIRE(results.iterations() == 1);
+                for (std::size_t i = 0; i < 3; ++i) {
+                    REQUIRE(results.optimized_values()[i] == Approx(reference.optimized_values()[i]));
+                }
+            }
+        }
+    }
+
+    GIVEN("A function without linear parameters") {
+        LinearFunction linear{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 100; ++i) {
+            vec.emplace_back(Measurement<1>{0.25 * static_cast<floating_t>(i), 4.0 * static_cast<floating_t>(i) - 3.0});
+        }
+
+        WHEN("the function is fitted") {
+            const auto results = variable_projection(linear, vec, 1e-15);
+            const auto found = results.optimized_values();
+            THEN("it is fitted like with Levenberg-Marquardt") {
+                REQUIRE(results.converged());
+                REQUIRE_THAT(found[0], Catch::Matchers::WithinRel(16.0, 1e-12));
+                REQUIRE_THAT(found[1], Catch::Matchers::WithinRel(-3.0, 1e-12));
+            }
+        }
+    }
+}
@@ -4,14 +4,61 @@
 #include "minimize/wssr.hpp"
 
 #include <cmath>
+#include <vector>
 
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "common.hpp"
+#include "minimize/thread_pool.hpp"
 
 using Catch::Approx;
 using namespace minimize;
 
+namespace {
+
+/** Linear function with an analytic gradient that counts how often each method is called. */
+class CountingLinearFunction : public LinearFunction {
+public:
+    virtual output_t evaluate(const input_t& x, const parameter_t& parameters) const {
+        ++evaluations;
+        return LinearFunction::evaluate(x, parameters);
+    }
+    using LinearFunction::evaluate;
+
+    virtual ValueAndGradient<2> evaluate_with_gradient(const input_t& x, const parameter_t& parameters) const {
+        ++fused_evaluations;
+        ValueAndGradient<2> rv;
+        rv.value = parameters[0] * x + parameters[1];
+        rv.gradient = {x, 1.0};
+        return rv;
+    }
+    using LinearFunction::evaluate_with_gradient;
+
+    mutable std::size_t evaluations{0};
+    mutable std::size_t fused_evaluations{0};
+};
+
+/** Linear function that records the sizes of the batches it is called with. */
+class BatchLinearFunction : public LinearFunction {
+public:
+    virtual void evaluate_batch(const input_t* x, std::size_t count, const parameter_t& parameters,
+                                output_t* out) const {
+        batches.push_back(count);
+        LinearFunction::evaluate_batch(x, count, parameters, out);
+    }
+
+    virtual void evaluate_with_gradient_batch(const input_t* x, std::size_t count, const parameter_t& parameters,
+                                              output_t* values, parameter_t* gradients) const {
+        gradient_batches.push_back(count);
+        LinearFunction::evaluate_with_gradient_batch(x, count, parameters, values, gradients);
+    }
+
+    mutable std::vector<std::size_t> batches{};
+    mutable std::vector<std::size_t> gradient_batches{};
+};
+
+}  // namespace
+
 SCENARIO("wssr can be computed", "[function]") {
     GIVEN("A linear function") {
         LinearFunction linear{};
@@ -88,8 +135,304 @@ SCENARIO("wssr gradient can be computed with weights", "[function]") {
             }
             const auto grad = compute_wssr_gradient(linear, vec);
             THEN("the gradient points to negative values") {
-                REQUIRE(grad[0] == Approx(-18.0));
-                REQUIRE(grad[1] == Approx(-4.0));
+                // 2 * (-0.1) / 0.25 * sum(x) and 2 * (-0.1) / 0.25 * 10
+                REQUIRE(grad[0] == Approx(-36.0));
+                REQUIRE(grad[1] == Approx(-8.0));
+            }
+        }
+
+        WHEN("wssr gradient is computed with different errors") {
+            Gaussian gaussian{};
+            MeasurementVectorWithErrors<1> vec{};
+            for (size_t i = 0; i < 40; ++i) {
+                double in{-10.0 + 0.25 * static_cast<double>(i)};
+                const double error = 0.25 + 0.5 * static_cast<double>(i % 4);
+                vec.push_back(MeasurementWithError<1>{in, compute_gaussian(in + 15.0), error});
+            }
+            const auto grad = compute_wssr_gradient(gaussian, vec);
+            THEN("it matches the finite difference of the wssr") {
+                const double h = 1e-6;
+                for (std::size_t k = 0; k < 2; ++k) {
+                    auto upper = gaussian.parameters();
+                    auto lower = gaussian.parameters();
+                    upper[k] += h;
+                    lower[k] -= h;
+                    const auto difference = compute_wssr(gaussian, vec, upper) - compute_wssr(gaussian, vec, lower);
+                    const auto expected = difference / (2 * h);
+                    REQUIRE(grad[k] == Approx(expected).epsilon(1e-5));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("wssr and gradient can be computed in one pass", "[function]") {
+    GIVEN("A linear function with an analytic gradient") {
+        CountingLinearFunction linear{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 10; ++i) {
+            double in{static_cast<double>(i)};
+            vec.push_back(Measurement<1>{in, linear.evaluate(in) + 0.1});
+        }
+        linear.evaluations = 0;
+
+        WHEN("the gradient is computed") {
+            const auto grad = compute_wssr_gradient(linear, vec);
+            THEN("only the fused method is called once per data point") {
+                REQUIRE(linear.evaluations == 0);
+                REQUIRE(linear.fused_evaluations == vec.size());
+                REQUIRE(grad[0] == Approx(-9.0));
+                REQUIRE(grad[1] == Approx(-2.0));
+            }
+        }
+
+        WHEN("wssr and gradient are computed together") {
+            const auto both = compute_wssr_and_gradient(linear, vec);
+            THEN("the results match the separate computations") {
+                REQUIRE(linear.fused_evaluations == vec.size());
+                REQUIRE(both.wssr == Approx(compute_wssr(linear, vec)));
+                REQUIRE(both.gradient[0] == Approx(-9.0));
+                REQUIRE(both.gradient[1] == Approx(-2.0));
+            }
+        }
+    }
+
+    GIVEN("A linear function and weighted data") {
+        LinearFunction linear{};
+        MeasurementVectorWithErrors<1> vec{};
+        for (size_t i = 0; i < 10; ++i) {
+            double in{static_cast<double>(i)};
+            vec.push_back(MeasurementWithError<1>{in, linear.evaluate(in) + 0.1, 0.5});
+        }
+
+        WHEN("wssr and gradient are computed together") {
+            const auto both = compute_wssr_and_gradient(linear, vec);
+            const auto grad = compute_wssr_gradient(linear, vec);
+            THEN("the results match the separate computations") {
+                REQUIRE(both.wssr == Approx(compute_wssr(linear, vec)));
+                REQUIRE(both.gradient[0] == Approx(grad[0]));
+                REQUIRE(both.gradient[1] == Approx(grad[1]));
+            }
+        }
+    }
+}
+
+SCENARIO("wssr is computed with batches of data points", "[function]") {
+    GIVEN("A function recording the batch sizes and more data points than fit in a batch") {
+        BatchLinearFunction linear{};
+        LinearFunction reference{};
+        const std::size_t points = 2 * detail::batch_size + 10;
+        MeasurementVector<1> vec{};
+        MeasurementVectorWithErrors<1> weighted{};
+        for (size_t i = 0; i < points; ++i) {
+            double in{0.01 * static_cast<double>(i)};
+            vec.push_back(Measurement<1>{in, reference.evaluate(in) + std::sin(in)});
+            weighted.push_back(MeasurementWithError<1>{in, reference.evaluate(in) + std::sin(in), 0.5});
+        }
+        const MeasurementColumns<1> columns{weighted};
+
+        WHEN("wssr is computed") {
+            const auto wssr = compute_wssr(linear, vec);
+            THEN("the function is called once per full batch and once for the remainder") {
+                REQUIRE(linear.batches == std::vector<std::size_t>{detail::batch_size, detail::batch_size, 10});
+                double expected = 0.0;
+                for (const auto& x : vec) {
+                    const auto diff = reference.evaluate(x.in) - x.out;
+                    expected += diff * diff;
+                }
+                REQUIRE(wssr == Approx(expected));
+            }
+        }
+
+        WHEN("wssr and gradient are computed") {
+            const auto both = compute_wssr_and_gradient(linear, vec);
+            THEN("all points are evaluated in gradient batches") {
+                std::size_t evaluated = 0;
+                for (const auto count : linear.gradient_batches) {
+                    REQUIRE(count <= detail::gradient_batch_size(2));
+                    evaluated += count;
+                }
+                REQUIRE(evaluated == points);
+                REQUIRE(both.wssr == Approx(compute_wssr(reference, vec)));
+            }
+        }
+
+        WHEN("the data is weighted or stored in columns") {
+            THEN("the results match the per point computation") {
+                double expected_weighted = 0.0;
+                for (const auto& x : weighted) {
+                    const auto diff = (reference.evaluate(x.in) - x.out) / x.error;
+                    expected_weighted += diff * diff;
+                }
+                REQUIRE(compute_wssr(linear, weighted) == Approx(expected_weighted));
+                REQUIRE(compute_wssr(linear, columns) == Approx(expected_weighted));
+                REQUIRE(compute_wssr_and_gradient(linear, columns).wssr == Approx(expected_weighted));
+            }
+        }
+    }
+}
+
+SCENARIO("wssr of large data sets is reduced in parallel", "[function]") {
+    GIVEN("A data set with more points than fit in a chunk of the reduction") {
+        Gaussian gauss{};
+        const std::size_t points = 3 * detail::reduction_chunk_size + 17;
+        MeasurementVectorWithErrors<1> vec{};
+        for (size_t i = 0; i < points; ++i) {
+            double in{-10.0 + 1e-3 * static_cast<double>(i)};
+            vec.push_back(MeasurementWithError<1>{in, compute_gaussian(in), 0.1 + 1e-6 * static_cast<double>(i)});
+        }
+        set_thread_count(1);
+        const auto serial_wssr = compute_wssr(gauss, vec);
+        const auto serial_both = compute_wssr_and_gradient(gauss, vec);
+
+        WHEN("the wssr is computed with several threads") {
+            set_thread_count(4);
+            const auto parallel_wssr = compute_wssr(gauss, vec);
+            const auto parallel_both = compute_wssr_and_gradient(gauss, vec);
+            set_thread_count(1);
+            THEN("the results are identical to the single threaded results") {
+                REQUIRE(parallel_wssr == serial_wssr);
+                REQUIRE(parallel_both.wssr == serial_both.wssr);
+                REQUIRE(parallel_both.gradient == serial_both.gradient);
+            }
+        }
+
+        WHEN("the wssr is computed point by point") {
+            double expected = 0.0;
+            for (const auto& x : vec) {
+                const auto diff = (gauss.evaluate(x.in, gauss.parameters()) - x.out) / x.error;
+                expected += diff * diff;
+            }
+            THEN("the chunked result matches") { REQUIRE(serial_wssr == Approx(expected).epsilon(1e-12)); }
+        }
+    }
+}
+
+SCENARIO("wssr sums the batches with compensation", "[function]") {
+    GIVEN("A large residual followed by small residuals in later batches") {
+        LinearFunction linear{};
+        const std::size_t batches = 101;
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < batches * detail::batch_size; ++i) {
+            double out{0.0};
+            if (i == 0) {
+                out = 1e8;
+            } else if (i % detail::batch_size == 0) {
+                out = 1.0;
+            }
+            vec.push_back(Measurement<1>{static_cast<double>(i), out});
+        }
+
+        WHEN("the wssr is computed") {
+            const auto wssr = compute_wssr(linear, vec, {0.0, 0.0});
+            THEN("the small residuals are not lost to rounding") { REQUIRE(wssr == 1e16 + 100.0); }
+        }
+    }
+}
+
+SCENARIO("wssr of several parameter sets is computed in one pass", "[function]") {
+    GIVEN("A data set with more points than fit in a chunk and several candidates") {
+        Gaussian gauss{};
+        const std::size_t points = 2 * detail::reduction_chunk_size + 300;
+        MeasurementVectorWithErrors<1> vec{};
+        for (size_t i = 0; i < points; ++i) {
+            double in{-10.0 + 5e-4 * static_cast<double>(i)};
+            vec.push_back(MeasurementWithError<1>{in, compute_gaussian(in), 0.1 + 1e-6 * static_cast<double>(i)});
+        }
+        const MeasurementColumns<1> columns{vec};
+        std::vector<parameter_t<2>> candidates;
+        for (std::size_t k = 0; k < 5; ++k) {
+            const double shift = 0.1 * static_cast<double>(k);
+            candidates.push_back(parameter_t<2>{{gauss.parameters()[0] + shift, gauss.parameters()[1] - shift}});
+        }
+
+        WHEN("the wssr of all candidates is computed") {
+            set_thread_count(3);
+            const auto wssr = compute_wssr_multi(gauss, vec, candidates);
+            std::vector<floating_t> column_wssr(candidates.size());
+            compute_wssr_multi(gauss, columns, candidates.data(), candidates.size(), column_wssr.data());
+            set_thread_count(1);
+            THEN("the results are identical to separate calls of compute_wssr") {
+                REQUIRE(wssr.size() == candidates.size());
+                for (std::size_t k = 0; k < candidates.size(); ++k) {
+                    REQUIRE(wssr[k] == compute_wssr(gauss, vec, candidates[k]));
+                    REQUIRE(column_wssr[k] == compute_wssr(gauss, columns, candidates[k]));
+                }
+            }
+        }
+
+        WHEN("no candidates are given") {
+            const auto wssr = compute_wssr_multi(gauss, vec, std::vector<parameter_t<2>>{});
+            THEN("nothing is computed") { REQUIRE(wssr.empty()); }
+        }
+    }
+}
+
+SCENARIO("wssr computations stop early above a threshold", "[function]") {
+    GIVEN("A data set with more points than fit in a chunk and candidates with growing wssr") {
+        Gaussian gauss{};
+        const std::size_t points = 2 * detail::reduction_chunk_size + 300;
+        MeasurementVectorWithErrors<1> vec{};
+        for (size_t i = 0; i < points; ++i) {
+            double in{-10.0 + 5e-4 * static_cast<double>(i)};
+            vec.push_back(MeasurementWithError<1>{in, compute_gaussian(in), 0.1 + 1e-6 * static_cast<double>(i)});
+        }
+        std::vector<parameter_t<2>> candidates;
+        std::vector<floating_t> expected;
+        for (std::size_t k = 0; k < 4; ++k) {
+            const double shift = 0.1 * static_cast<double>(k);
+            candidates.push_back(parameter_t<2>{{gauss.parameters()[0] + shift, gauss.parameters()[1] - shift}});
+            expected.push_back(compute_wssr(gauss, vec, candidates.back()));
+        }
+        REQUIRE(expected[0] < expected[1]);
+        REQUIRE(expected[1] < expected[2]);
+        const auto threshold = 0.5 * (expected[0] + expected[1]);
+
+        WHEN("the wssr is below the threshold") {
+            set_thread_count(3);
+            const auto wssr = compute_wssr_bounded(gauss, vec, candidates[0], threshold);
+            set_thread_count(1);
+            THEN("the result is identical to compute_wssr") { REQUIRE(wssr == expected[0]); }
+        }
+
+        WHEN("the wssr is above the threshold") {
+            set_thread_count(3);
+            const auto wssr = compute_wssr_bounded(gauss, vec, candidates[1], threshold);
+            set_thread_count(1);
+            THEN("infinity is returned") { REQUIRE(std::isinf(wssr)); }
+        }
+
+        WHEN("the wssr of several candidates is computed with a threshold") {
+            std::vector<floating_t> wssr(candidates.size());
+            set_thread_count(3);
+            compute_wssr_multi_bounded(gauss, vec, candidates.data(), candidates.size(), threshold, wssr.data());
+            set_thread_count(1);
+            THEN("the candidates up to the first one above the threshold are computed") {
+                REQUIRE(wssr[0] == expected[0]);
+                REQUIRE(wssr[1] == expected[1]);
+                REQUIRE(std::isinf(wssr[2]));
+                REQUIRE(std::isinf(wssr[3]));
+            }
+        }
+    }
+
+    GIVEN("A linear function that records its batches") {
+        BatchLinearFunction linear{};
+        MeasurementVector<1> vec{};
+        for (size_t i = 0; i < 4 * detail::bounded_block_size; ++i) {
+            double in{static_cast<double>(i)};
+            vec.push_back(Measurement<1>{in, 1.0});
+        }
+
+        WHEN("the wssr exceeds the threshold in the first block") {
+            const auto wssr = compute_wssr_bounded(linear, vec, linear.parameters(), 1.0);
+            std::size_t evaluated = 0;
+            for (const auto count : linear.batches) {
+                evaluated += count;
+            }
+            THEN("only the first block is evaluated") {
+                REQUIRE(std::isinf(wssr));
+                REQUIRE(evaluated == detail::bounded_block_size);
             }
         }
     }